@@ -0,0 +1,639 @@
+// benchmark.cpp
+// Benchmark suite over all levels in problems/, with console or JSON output for tracking regressions.
+// Each benchmark runs a fixed amount of work per iteration, the number of iterations is doubled until a run takes
+// at least the minimum time, and the reported time per item is the median over the repetitions.
+
+#include <sokoban/sokoban.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace sokoban;
+
+namespace {
+constexpr double NANOSECONDS_PER_SECOND = 1e9;
+constexpr double DEFAULT_MIN_TIME = 0.2;
+constexpr int DEFAULT_REPETITIONS = 3;
+constexpr std::size_t FRONTIER_STATES = 1024;
+constexpr int VEC_ENV_SIZE = 512;
+constexpr std::size_t VEC_ENV_ACTION_ROWS = 64;
+constexpr uint64_t SOLVER_MAX_EXPANSIONS = 1000000;
+constexpr const char* SOLVER_PROBLEMS_FILE = "unfiltered_test_100.txt";
+
+// Results are folded into this so the compiler can't drop the benchmarked work
+volatile uint64_t sink = 0;    // NOLINT(*-avoid-non-const-global-variables)
+
+struct Options {
+    std::string problems_dir = SOKOBAN_PROBLEMS_DIR;
+    std::string format = "console";
+    std::string out;
+    std::string filter;
+    double min_time = DEFAULT_MIN_TIME;
+    int repetitions = DEFAULT_REPETITIONS;
+};
+
+// Named value reported next to the timing of a benchmark
+struct Counter {
+    std::string name;
+    double value;
+};
+
+struct Benchmark {
+    std::string name;
+    std::size_t items_per_iteration;
+    std::function<void()> iteration;
+    // Counters of the last iteration, given the median time of an iteration in seconds, if any
+    std::function<std::vector<Counter>(double)> counters = nullptr;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    std::size_t items_per_iteration;
+    double median_ns;    // Per item
+    double min_ns;       // Per item
+    std::vector<Counter> counters;
+};
+
+struct Suite {
+    std::vector<std::string> files;
+    std::vector<std::string> board_strs;
+    std::string text;    // All board strings, one per line
+    std::vector<SokobanGameState> initial_states;
+    std::vector<SokobanGameState> solver_states;    // Levels of SOLVER_PROBLEMS_FILE, if the directory has it
+};
+
+void print_usage() {
+    std::cout << "Usage: sokoban_benchmark [--problems=DIR] [--format=console|json] [--out=FILE] [--filter=TEXT]\n"
+                 "                         [--min-time=SECONDS] [--repetitions=N]\n"
+                 "  --problems     Directory whose .txt level files are benchmarked (default "
+              << SOKOBAN_PROBLEMS_DIR
+              << ")\n"
+                 "  --format       Output format (default console)\n"
+                 "  --out          File to write the output to (default standard output)\n"
+                 "  --filter       Only run benchmarks whose name contains the text\n"
+                 "  --min-time     Minimum time of each repetition (default 0.2)\n"
+                 "  --repetitions  Repetitions of each benchmark, the median is reported (default 3)"
+              << std::endl;
+}
+
+auto parse_options(int argc, char** argv) -> Options {
+    Options options;
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    for (const auto& arg : args) {
+        const auto eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--problems") {
+            options.problems_dir = value;
+        } else if (key == "--format") {
+            options.format = value;
+        } else if (key == "--out") {
+            options.out = value;
+        } else if (key == "--filter") {
+            options.filter = value;
+        } else if (key == "--min-time") {
+            options.min_time = std::stod(value);
+        } else if (key == "--repetitions") {
+            options.repetitions = std::stoi(value);
+        } else {
+            throw std::invalid_argument("Unknown argument " + arg);
+        }
+    }
+    if (options.format != "console" && options.format != "json") {
+        throw std::invalid_argument("Unknown format " + options.format);
+    }
+    if (options.min_time < 0 || options.repetitions < 1) {
+        throw std::invalid_argument("Expected a non-negative min time and a positive number of repetitions");
+    }
+    return options;
+}
+
+// Every level of every .txt file in the directory, in file name order, without duplicates
+auto load_suite(const std::string& problems_dir) -> Suite {
+    Suite suite;
+    for (const auto& entry : std::filesystem::directory_iterator(problems_dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+            suite.files.push_back(entry.path().string());
+        }
+    }
+    std::sort(suite.files.begin(), suite.files.end());
+    std::unordered_set<std::string> seen;
+    for (const auto& file : suite.files) {
+        std::ifstream stream(file);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty() && seen.insert(line).second) {
+                suite.board_strs.push_back(line);
+                suite.text += line + '\n';
+            }
+        }
+    }
+    if (suite.board_strs.empty()) {
+        throw std::invalid_argument("No levels found in " + problems_dir);
+    }
+    suite.initial_states.reserve(suite.board_strs.size());
+    for (const auto& board_str : suite.board_strs) {
+        suite.initial_states.emplace_back(board_str);
+    }
+    std::ifstream solver_stream(std::filesystem::path(problems_dir) / SOLVER_PROBLEMS_FILE);
+    std::string line;
+    while (std::getline(solver_stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            suite.solver_states.emplace_back(line);
+        }
+    }
+    return suite;
+}
+
+// Random action among the ones which change the state, none if the agent is stuck. Only initial states can be stuck,
+// as walking back is legal after any move.
+auto random_legal_action(const SokobanGameState& state, std::minstd_rand& rng) noexcept -> std::optional<Action> {
+    const uint8_t mask = state.legal_action_mask();
+    if (mask == 0) {
+        return std::nullopt;
+    }
+    auto nth = static_cast<int>(rng() % static_cast<unsigned>(std::popcount(mask)));
+    for (int a = 0; a < kNumActions; ++a) {
+        if ((mask & (1U << static_cast<unsigned>(a))) != 0 && nth-- == 0) {
+            return static_cast<Action>(a);
+        }
+    }
+    return std::nullopt;
+}
+
+// States after a short random walk, so benchmarks don't only see initial states
+auto walked_states(const Suite& suite, int num_steps) -> std::vector<SokobanGameState> {
+    std::vector<SokobanGameState> states = suite.initial_states;
+    std::minstd_rand rng;
+    for (auto& state : states) {
+        for (int i = 0; i < num_steps && !state.is_solution(); ++i) {
+            const auto action = random_legal_action(state, rng);
+            if (!action) {
+                break;
+            }
+            state.apply_action(*action);
+        }
+    }
+    return states;
+}
+
+// Largest buffer size any of the states needs, as levels of the suite may differ in size
+template <typename SizeFunc>
+auto max_size(const std::vector<SokobanGameState>& states, SizeFunc size) -> std::size_t {
+    std::size_t largest = 0;
+    for (const auto& state : states) {
+        largest = std::max(largest, static_cast<std::size_t>(size(state)));
+    }
+    return largest;
+}
+
+// Batched steps with observations, for each number of threads. A vectorized environment needs levels of one size, so
+// the pool is the levels with the dimensions of the first level.
+void add_vec_env_benchmarks(const Suite& suite, std::vector<Benchmark>& benchmarks) {
+    const auto& first = *suite.initial_states.front().get_level();
+    std::vector<SokobanGameState> pool;
+    for (const auto& state : suite.initial_states) {
+        if (state.get_level()->get_rows() == first.get_rows() && state.get_level()->get_cols() == first.get_cols()) {
+            pool.push_back(state);
+        }
+    }
+    // Actions are drawn up front so the timing only covers stepping
+    auto actions = std::make_shared<std::vector<int32_t>>(VEC_ENV_ACTION_ROWS * VEC_ENV_SIZE);
+    std::minstd_rand rng;
+    for (auto& action : *actions) {
+        action = static_cast<int32_t>(rng() % kNumActions);
+    }
+    for (const int num_threads : {1, 2, 4, 8}) {
+        auto env = std::make_shared<SokobanVecEnv>(pool, VEC_ENV_SIZE, 0, false, num_threads);
+        auto reward_signals = std::make_shared<std::vector<uint64_t>>(VEC_ENV_SIZE);
+        auto solved = std::make_shared<std::vector<uint8_t>>(VEC_ENV_SIZE);
+        auto obs = std::make_shared<std::vector<float>>(env->observation_size() * VEC_ENV_SIZE);
+        auto row = std::make_shared<std::size_t>(0);
+        benchmarks.push_back({"vec_env/step/threads:" + std::to_string(num_threads), VEC_ENV_SIZE,
+                              [env, actions, reward_signals, solved, obs, row]() {
+                                  *row = (*row + 1) % VEC_ENV_ACTION_ROWS;
+                                  env->step(&(*actions)[*row * VEC_ENV_SIZE], reward_signals->data(), solved->data(),
+                                            obs->data());
+                                  sink = sink + (*reward_signals)[0];
+                              }});
+    }
+}
+
+// HDA* over the levels of SOLVER_PROBLEMS_FILE for each number of threads, counting solved levels and expanded nodes
+// so the scaling can be judged by more than the time
+void add_solver_benchmarks(const Suite& suite, std::vector<Benchmark>& benchmarks) {
+    if (suite.solver_states.empty()) {
+        return;
+    }
+    for (const int num_threads : {1, 2, 4, 8}) {
+        SolverOptions options;
+        options.algorithm = SearchAlgorithm::kHDAStar;
+        options.num_threads = num_threads;
+        options.max_expansions = SOLVER_MAX_EXPANSIONS;
+        auto solved = std::make_shared<int>(0);
+        auto expanded = std::make_shared<uint64_t>(0);
+        benchmarks.push_back({"solver/hda_star/threads:" + std::to_string(num_threads), suite.solver_states.size(),
+                              [&suite, options, solved, expanded]() {
+                                  *solved = 0;
+                                  *expanded = 0;
+                                  for (const auto& state : suite.solver_states) {
+                                      const auto result = solve(state, options);
+                                      *solved += result.status == SolverStatus::kSolved ? 1 : 0;
+                                      *expanded += result.stats.expanded;
+                                  }
+                                  sink = sink + *expanded;
+                              },
+                              [solved, expanded](double seconds) -> std::vector<Counter> {
+                                  return {{"solved", static_cast<double>(*solved)},
+                                          {"expanded_per_second", static_cast<double>(*expanded) / seconds}};
+                              }});
+    }
+}
+
+auto make_benchmarks(const Suite& suite) -> std::vector<Benchmark> {
+    constexpr int WALK_STEPS = 20;
+    const std::size_t n = suite.initial_states.size();
+    const auto shared_states = std::make_shared<std::vector<SokobanGameState>>(walked_states(suite, WALK_STEPS));
+    const auto& states = *shared_states;
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"parse/board_string", n, [&suite]() {
+                              for (const auto& board_str : suite.board_strs) {
+                                  const SokobanGameState state(board_str);
+                                  sink = sink + state.get_hash();
+                              }
+                          }});
+    benchmarks.push_back({"parse/level_store", n, [&suite]() {
+                              const auto store = LevelStore::from_string(suite.text);
+                              sink = sink + store.size();
+                          }});
+
+    // One random legal step of every level, solved levels start over and stuck levels are skipped
+    auto stepped = std::make_shared<std::vector<SokobanGameState>>(suite.initial_states);
+    auto rng = std::make_shared<std::minstd_rand>();
+    benchmarks.push_back({"step/random_legal", n, [&suite, stepped, rng]() {
+                              for (std::size_t i = 0; i < stepped->size(); ++i) {
+                                  auto& state = (*stepped)[i];
+                                  const auto action = random_legal_action(state, *rng);
+                                  if (!action) {
+                                      continue;
+                                  }
+                                  state.apply_action(*action);
+                                  if (state.is_solution()) {
+                                      state = suite.initial_states[i];
+                                  }
+                              }
+                              sink = sink + (*stepped)[0].get_hash();
+                          }});
+
+    // Same walk, with each level's observation kept up to date by a cache instead of being rebuilt
+    auto cached = std::make_shared<std::vector<SokobanGameState>>(suite.initial_states);
+    auto caches = std::make_shared<std::vector<ObservationCache>>(n, ObservationCache(true));
+    auto cached_rng = std::make_shared<std::minstd_rand>();
+    benchmarks.push_back({"step/random_legal_cached_observation", n, [&suite, cached, caches, cached_rng]() {
+                              for (std::size_t i = 0; i < cached->size(); ++i) {
+                                  auto& state = (*cached)[i];
+                                  const auto action = random_legal_action(state, *cached_rng);
+                                  if (!action) {
+                                      continue;
+                                  }
+                                  state.apply_action(*action);
+                                  if (state.is_solution()) {
+                                      state = suite.initial_states[i];
+                                  }
+                                  sink = sink + static_cast<uint64_t>((*caches)[i].update(state)[0]);
+                              }
+                          }});
+
+    auto copies = std::make_shared<std::vector<SokobanGameState>>(states);
+    benchmarks.push_back({"copy/assign", n, [shared_states, copies]() {
+                              std::copy(shared_states->begin(), shared_states->end(), copies->begin());
+                              sink = sink + copies->back().get_hash();
+                          }});
+
+    benchmarks.push_back({"hash/get_hash", n, [shared_states]() {
+                              uint64_t total = 0;
+                              for (const auto& state : *shared_states) {
+                                  total += state.get_hash();
+                              }
+                              sink = sink + total;
+                          }});
+    auto generator = std::make_shared<PushGenerator>();
+    benchmarks.push_back({"hash/canonical_key", n, [shared_states, generator]() {
+                              uint64_t total = 0;
+                              for (const auto& state : *shared_states) {
+                                  total += generator->canonical_key(state);
+                              }
+                              sink = sink + total;
+                          }});
+
+    for (const bool compact : {true, false}) {
+        const auto size = max_size(states, [compact](const SokobanGameState& state) {
+            return state.observation_size(ObservationFormat::kFloat, compact);
+        });
+        auto obs = std::make_shared<std::vector<float>>(size);
+        benchmarks.push_back({std::string("observation/float/") + (compact ? "compact" : "full"), n,
+                              [shared_states, obs, compact]() {
+                                  for (const auto& state : *shared_states) {
+                                      state.write_observation(obs->data(), compact);
+                                  }
+                                  sink = sink + static_cast<uint64_t>((*obs)[0]);
+                              }});
+    }
+    for (const auto& [format, format_name] : {std::pair{ObservationFormat::kUint8, "uint8"},
+                                              std::pair{ObservationFormat::kCellCode, "cell_code"},
+                                              std::pair{ObservationFormat::kBitPacked, "bit_packed"}}) {
+        const auto size = max_size(states, [format](const SokobanGameState& state) {
+            return state.observation_size(format, true);
+        });
+        auto obs = std::make_shared<std::vector<uint8_t>>(size);
+        benchmarks.push_back({std::string("observation/") + format_name + "/compact", n,
+                              [shared_states, obs, format]() {
+                                  for (const auto& state : *shared_states) {
+                                      state.write_observation(obs->data(), format, true);
+                                  }
+                                  sink = sink + (*obs)[0];
+                              }});
+    }
+
+    for (const auto tile_size : {TileSize::k32, TileSize::k8}) {
+        const auto size = max_size(states, [tile_size](const SokobanGameState& state) {
+            const auto shape = state.image_shape(tile_size);
+            return shape[0] * shape[1] * shape[2];
+        });
+        auto image = std::make_shared<std::vector<uint8_t>>(size);
+        benchmarks.push_back({"render/write_image/" + std::to_string(static_cast<int>(tile_size)), n,
+                              [shared_states, image, tile_size]() {
+                                  for (const auto& state : *shared_states) {
+                                      state.write_image(image->data(), tile_size);
+                                  }
+                                  sink = sink + (*image)[0];
+                              }});
+    }
+
+    benchmarks.push_back({"query/is_solution", n, [shared_states]() {
+                              uint64_t total = 0;
+                              for (const auto& state : *shared_states) {
+                                  total += state.is_solution() ? 1 : 0;
+                              }
+                              sink = sink + total;
+                          }});
+    benchmarks.push_back({"query/is_deadlocked", n, [shared_states]() {
+                              uint64_t total = 0;
+                              for (const auto& state : *shared_states) {
+                                  total += state.is_deadlocked() ? 1 : 0;
+                              }
+                              sink = sink + total;
+                          }});
+    benchmarks.push_back({"query/legal_action_mask", n, [shared_states]() {
+                              uint64_t total = 0;
+                              for (const auto& state : *shared_states) {
+                                  total += state.legal_action_mask();
+                              }
+                              sink = sink + total;
+                          }});
+
+    // Breadth first expansion without duplicate detection, storing every child, as a search frontier would
+    auto frontier = std::make_shared<std::vector<SokobanGameState>>();
+    benchmarks.push_back({"frontier/vector_of_states", n * FRONTIER_STATES, [&suite, frontier]() {
+                              for (const auto& initial : suite.initial_states) {
+                                  frontier->clear();
+                                  frontier->push_back(initial);
+                                  for (std::size_t j = 0; frontier->size() < FRONTIER_STATES; ++j) {
+                                      const SokobanGameState parent = (*frontier)[j];
+                                      for (int a = 0; a < kNumActions; ++a) {
+                                          SokobanGameState child = parent;
+                                          child.apply_action(static_cast<Action>(a));
+                                          frontier->push_back(child);
+                                      }
+                                  }
+                              }
+                              sink = sink + frontier->back().get_hash();
+                          }});
+    auto pools = std::make_shared<std::vector<StatePool>>();
+    for (const auto& initial : suite.initial_states) {
+        pools->emplace_back(initial, 0, FRONTIER_STATES * 2);
+    }
+    benchmarks.push_back({"frontier/state_pool", n * FRONTIER_STATES, [&suite, pools]() {
+                              for (std::size_t i = 0; i < pools->size(); ++i) {
+                                  auto& pool = (*pools)[i];
+                                  SokobanGameState scratch = suite.initial_states[i];
+                                  pool.clear();
+                                  (void)pool.push(scratch);
+                                  for (StateHandle j = 0; pool.size() < FRONTIER_STATES; ++j) {
+                                      for (int a = 0; a < kNumActions; ++a) {
+                                          pool.load(j, scratch);
+                                          scratch.apply_action(static_cast<Action>(a));
+                                          (void)pool.push(scratch);
+                                      }
+                                  }
+                                  sink = sink + pool.get_hash(static_cast<StateHandle>(pool.size() - 1));
+                              }
+                          }});
+    add_vec_env_benchmarks(suite, benchmarks);
+    add_solver_benchmarks(suite, benchmarks);
+    return benchmarks;
+}
+
+// Time of running the benchmark for the given number of iterations
+auto time_iterations(const Benchmark& benchmark, uint64_t iterations) -> double {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        benchmark.iteration();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+auto run_benchmark(const Benchmark& benchmark, const Options& options) -> Result {
+    // Warm up caches and let lazily grown buffers reach their size
+    benchmark.iteration();
+    uint64_t iterations = 1;
+    double seconds = time_iterations(benchmark, iterations);
+    while (seconds < options.min_time) {
+        iterations *= 2;
+        seconds = time_iterations(benchmark, iterations);
+    }
+    std::vector<double> per_item = {seconds};
+    for (int r = 1; r < options.repetitions; ++r) {
+        per_item.push_back(time_iterations(benchmark, iterations));
+    }
+    const double items = static_cast<double>(iterations) * static_cast<double>(benchmark.items_per_iteration);
+    for (auto& value : per_item) {
+        value = value * NANOSECONDS_PER_SECOND / items;
+    }
+    std::sort(per_item.begin(), per_item.end());
+    Result result{.name = benchmark.name,
+                  .iterations = iterations,
+                  .items_per_iteration = benchmark.items_per_iteration,
+                  .median_ns = per_item[per_item.size() / 2],
+                  .min_ns = per_item.front(),
+                  .counters = {}};
+    if (benchmark.counters) {
+        const double iteration_seconds =
+            result.median_ns * static_cast<double>(benchmark.items_per_iteration) / NANOSECONDS_PER_SECOND;
+        result.counters = benchmark.counters(iteration_seconds);
+    }
+    return result;
+}
+
+// Speedup of a "<name>/threads:N" result over the "<name>/threads:1" result, if that ran before it
+void add_speedup_counter(const std::vector<Result>& previous, Result& result) {
+    const std::string threads = "/threads:";
+    const auto pos = result.name.rfind(threads);
+    if (pos == std::string::npos) {
+        return;
+    }
+    const std::string base_name = result.name.substr(0, pos + threads.size()) + "1";
+    for (const auto& base : previous) {
+        if (base.name == base_name) {
+            result.counters.push_back({"speedup", base.median_ns / result.median_ns});
+        }
+    }
+}
+
+auto json_string(const std::string& value) -> std::string {
+    std::string escaped = "\"";
+    for (const char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+auto current_date() -> std::string {
+    const std::time_t now = std::time(nullptr);
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &now);
+#else
+    gmtime_r(&now, &utc);
+#endif
+    std::ostringstream oss;
+    oss << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ");
+    return oss.str();
+}
+
+void write_json(std::ostream& os, const Suite& suite, const Options& options, const std::vector<Result>& results) {
+    os << "{\n  \"context\": {\n";
+    os << "    \"date\": " << json_string(current_date()) << ",\n";
+    os << "    \"library_version\": " << json_string(SOKOBAN_VERSION) << ",\n";
+    os << "    \"build_type\": " << json_string(SOKOBAN_BUILD_TYPE) << ",\n";
+    os << "    \"max_cells\": " << kMaxCells << ",\n";
+    os << "    \"min_time\": " << options.min_time << ",\n";
+    os << "    \"repetitions\": " << options.repetitions << ",\n";
+    os << "    \"num_levels\": " << suite.initial_states.size() << ",\n";
+    os << "    \"num_solver_levels\": " << suite.solver_states.size() << ",\n";
+    os << "    \"level_files\": [";
+    for (std::size_t i = 0; i < suite.files.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << json_string(std::filesystem::path(suite.files[i]).filename().string());
+    }
+    os << "]\n  },\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        os << "    {\"name\": " << json_string(result.name) << ", \"iterations\": " << result.iterations
+           << ", \"items_per_iteration\": " << result.items_per_iteration << ", \"time_ns\": " << result.median_ns
+           << ", \"min_time_ns\": " << result.min_ns
+           << ", \"items_per_second\": " << NANOSECONDS_PER_SECOND / result.median_ns;
+        for (const auto& counter : result.counters) {
+            os << ", " << json_string(counter.name) << ": " << counter.value;
+        }
+        os << "}" << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    os << "  ]\n}" << std::endl;
+}
+
+void write_console_header(std::ostream& os, const Suite& suite) {
+    constexpr int NAME_WIDTH = 40;
+    constexpr int COLUMN_WIDTH = 16;
+    os << suite.initial_states.size() << " levels from " << suite.files.size() << " files\n";
+    os << std::left << std::setw(NAME_WIDTH) << "benchmark" << std::right << std::setw(COLUMN_WIDTH) << "ns/item"
+       << std::setw(COLUMN_WIDTH) << "min ns/item" << std::setw(COLUMN_WIDTH) << "items/s" << std::setw(COLUMN_WIDTH)
+       << "iterations" << "  counters" << std::endl;
+}
+
+void write_console_row(std::ostream& os, const Result& result) {
+    constexpr int NAME_WIDTH = 40;
+    constexpr int COLUMN_WIDTH = 16;
+    constexpr int COUNTER_PRECISION = 6;
+    os << std::left << std::setw(NAME_WIDTH) << result.name << std::right << std::fixed << std::setprecision(2)
+       << std::setw(COLUMN_WIDTH) << result.median_ns << std::setw(COLUMN_WIDTH) << result.min_ns
+       << std::setprecision(0) << std::setw(COLUMN_WIDTH) << NANOSECONDS_PER_SECOND / result.median_ns
+       << std::setw(COLUMN_WIDTH) << result.iterations << std::defaultfloat << std::setprecision(COUNTER_PRECISION)
+       << " ";
+    for (const auto& counter : result.counters) {
+        os << " " << counter.name << "=" << counter.value;
+    }
+    os << std::endl;
+}
+}    // namespace
+
+int main(int argc, char** argv) {
+    const std::vector<std::string> args(argv + 1, argv + argc);
+    if (std::find(args.begin(), args.end(), "--help") != args.end()) {
+        print_usage();
+        return 0;
+    }
+    try {
+        const Options options = parse_options(argc, argv);
+        const Suite suite = load_suite(options.problems_dir);
+        std::ofstream file;
+        if (!options.out.empty()) {
+            file.open(options.out);
+            if (!file) {
+                throw std::invalid_argument("Can't write to " + options.out);
+            }
+        }
+        std::ostream& os = options.out.empty() ? std::cout : file;
+        const bool json = options.format == "json";
+        if (!json) {
+            write_console_header(os, suite);
+        }
+        std::vector<Result> results;
+        for (const auto& benchmark : make_benchmarks(suite)) {
+            if (benchmark.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            auto result = run_benchmark(benchmark, options);
+            add_speedup_counter(results, result);
+            results.push_back(std::move(result));
+            if (!json) {
+                write_console_row(os, results.back());
+            }
+        }
+        if (json) {
+            write_json(os, suite, options, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        print_usage();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,214 @@
+#ifndef SOKOBAN_BITBOARD_H_
+#define SOKOBAN_BITBOARD_H_
+
+#include <sokoban/definitions.h>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace sokoban {
+
+// Fixed-width set of board cells, one bit per flat index.
+// Trivially copyable so states holding it can be copied with a memcpy and compared with a few word compares.
+template <std::size_t N>
+class Bitboard {
+    static_assert(N > 0 && N % 64 == 0, "Bitboard width must be a positive multiple of 64");
+
+public:
+    static constexpr std::size_t kNumBits = N;
+    static constexpr std::size_t kNumWords = N / 64;
+
+    constexpr Bitboard() noexcept = default;
+
+    constexpr auto operator==(const Bitboard& other) const noexcept -> bool = default;
+
+    /**
+     * Check if the bit at the given index is set.
+     * @param index Flat index of the cell
+     * @return True if set, false otherwise
+     */
+    [[nodiscard]] constexpr auto test(int index) const noexcept -> bool {
+        return (words[WordIndex(index)] >> BitIndex(index)) & 1;
+    }
+
+    /**
+     * Set the bit at the given index.
+     * @param index Flat index of the cell
+     */
+    constexpr void set(int index) noexcept {
+        words[WordIndex(index)] |= uint64_t{1} << BitIndex(index);
+    }
+
+    /**
+     * Set the bit at the given index to the given value.
+     * @param index Flat index of the cell
+     * @param value Value to set
+     */
+    constexpr void set(int index, bool value) noexcept {
+        value ? set(index) : reset(index);
+    }
+
+    /**
+     * Clear the bit at the given index.
+     * @param index Flat index of the cell
+     */
+    constexpr void reset(int index) noexcept {
+        words[WordIndex(index)] &= ~(uint64_t{1} << BitIndex(index));
+    }
+
+    /**
+     * Clear all bits.
+     */
+    constexpr void clear() noexcept {
+        words.fill(0);
+    }
+
+    /**
+     * Get the number of set bits.
+     * @return Count of set bits
+     */
+    [[nodiscard]] constexpr auto count() const noexcept -> int {
+        int result = 0;
+        for (const auto& w : words) {
+            result += std::popcount(w);
+        }
+        return result;
+    }
+
+    /**
+     * Check if any bit is set.
+     * @return True if at least one bit set, false otherwise
+     */
+    [[nodiscard]] constexpr auto any() const noexcept -> bool {
+        uint64_t acc = 0;
+        for (const auto& w : words) {
+            acc |= w;
+        }
+        return acc != 0;
+    }
+
+    /**
+     * Check if no bit is set.
+     * @return True if no bits are set, false otherwise
+     */
+    [[nodiscard]] constexpr auto none() const noexcept -> bool {
+        return !any();
+    }
+
+    /**
+     * Check if every bit set in this is also set in other.
+     * @param other Bitboard to check against
+     * @return True if this is a subset of other
+     */
+    [[nodiscard]] constexpr auto is_subset_of(const Bitboard& other) const noexcept -> bool {
+        uint64_t acc = 0;
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            acc |= words[i] & ~other.words[i];
+        }
+        return acc == 0;
+    }
+
+    /**
+     * Call the given function with the index of every set bit, in increasing order.
+     * @param func Callable taking the int flat index
+     */
+    template <typename F>
+    constexpr void for_each(F&& func) const {
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            uint64_t w = words[i];
+            while (w != 0) {
+                func(static_cast<int>((i * 64) + static_cast<std::size_t>(std::countr_zero(w))));
+                w &= w - 1;
+            }
+        }
+    }
+
+    /**
+     * Get the index of the lowest set bit.
+     * @return Flat index of the lowest set cell, or -1 if no bits are set
+     */
+    [[nodiscard]] constexpr auto find_first() const noexcept -> int {
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            if (words[i] != 0) {
+                return static_cast<int>((i * 64) + static_cast<std::size_t>(std::countr_zero(words[i])));
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Get the underlying 64-bit words, least significant cells first.
+     * @return Array of words
+     */
+    [[nodiscard]] constexpr auto get_words() const noexcept -> const std::array<uint64_t, kNumWords>& {
+        return words;
+    }
+
+    /**
+     * Get the underlying 64-bit words for writing, least significant cells first.
+     * @return Array of words
+     */
+    [[nodiscard]] constexpr auto get_words() noexcept -> std::array<uint64_t, kNumWords>& {
+        return words;
+    }
+
+    constexpr auto operator&=(const Bitboard& other) noexcept -> Bitboard& {
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator|=(const Bitboard& other) noexcept -> Bitboard& {
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+    constexpr auto operator^=(const Bitboard& other) noexcept -> Bitboard& {
+        for (std::size_t i = 0; i < kNumWords; ++i) {
+            words[i] ^= other.words[i];
+        }
+        return *this;
+    }
+    [[nodiscard]] constexpr auto operator~() const noexcept -> Bitboard {
+        Bitboard result = *this;
+        for (auto& w : result.words) {
+            w = ~w;
+        }
+        return result;
+    }
+    [[nodiscard]] friend constexpr auto operator&(Bitboard lhs, const Bitboard& rhs) noexcept -> Bitboard {
+        return lhs &= rhs;
+    }
+    [[nodiscard]] friend constexpr auto operator|(Bitboard lhs, const Bitboard& rhs) noexcept -> Bitboard {
+        return lhs |= rhs;
+    }
+    [[nodiscard]] friend constexpr auto operator^(Bitboard lhs, const Bitboard& rhs) noexcept -> Bitboard {
+        return lhs ^= rhs;
+    }
+
+private:
+    [[nodiscard]] constexpr static auto WordIndex(int index) noexcept -> std::size_t {
+        return static_cast<std::size_t>(index) / 64;
+    }
+    [[nodiscard]] constexpr static auto BitIndex(int index) noexcept -> std::size_t {
+        return static_cast<std::size_t>(index) % 64;
+    }
+
+    std::array<uint64_t, kNumWords> words{};
+};
+
+using Bitboard128 = Bitboard<128>;    // NOLINT(*-magic-numbers)
+using Bitboard256 = Bitboard<256>;    // NOLINT(*-magic-numbers)
+using Bitboard512 = Bitboard<512>;    // NOLINT(*-magic-numbers)
+
+// Bitboard wide enough for any supported level, see kMaxCells
+using BoardBitboard = Bitboard<static_cast<std::size_t>(kMaxCells)>;
+static_assert(std::is_trivially_copyable_v<BoardBitboard>);
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_BITBOARD_H_
@@ -3,12 +3,22 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
 
+// Maximum number of cells (rows * cols) a level can have, set through the SOKOBAN_MAX_CELLS cmake option
+#ifndef SOKOBAN_MAX_CELLS
+#define SOKOBAN_MAX_CELLS 512
+#endif
+
 namespace sokoban {
 
+constexpr int kMaxCells = SOKOBAN_MAX_CELLS;
+static_assert(kMaxCells > 0 && kMaxCells % 64 == 0, "SOKOBAN_MAX_CELLS must be a positive multiple of 64");
+
 // Types of elements in the game
 enum class Element {
     kAgent = 0,
@@ -24,6 +34,33 @@ constexpr int kNumChannels = 7;
 constexpr int ChannelAgentOnGoal = 5;
 constexpr int ChannelBoxOnGoal = 6;
 
+// Formats observations can be written in
+enum class ObservationFormat {
+    kFloat = 0,        // One-hot float channels
+    kUint8 = 1,        // One-hot uint8 channels
+    kCellCode = 2,     // Single uint8 channel holding the level format code of each cell (see CellCode)
+    kBitPacked = 3,    // One-hot channels, each channel plane packed 8 cells per byte (little bit order)
+};
+
+// Cell codes used by the level format and ObservationFormat::kCellCode
+enum class CellCode : uint8_t {
+    kAgent = 0,
+    kWall = 1,
+    kBox = 2,
+    kGoal = 3,
+    kEmpty = 4,
+    kAgentOnGoal = 5,
+    kBoxOnGoal = 6,
+};
+
+// Pixels per side of each board tile in rendered images
+enum class TileSize {
+    k1 = 1,
+    k8 = 8,
+    k16 = 16,
+    k32 = 32,
+};
+
 // Possible actions for the agent to take
 enum class Action {
     kUp = 0,
@@ -33,10 +70,17 @@ enum class Action {
 };
 constexpr int kNumActions = 4;
 
+// Sentinel cell index for moves which leave the board or enter a wall
+constexpr int kNoCell = -1;
+
+// Sentinel distance for cells from which a target can't be reached
+constexpr int kUnreachable = std::numeric_limits<int>::max();
+
 // Bitfields to capture events
 enum RewardCodes {
     kRewardBoxInGoal = 1 << 0,
     kRewardAllBoxesInGoal = 1 << 1,
+    kRewardDeadlock = 1 << 2,    // Only set when enabled with SokobanGameState::set_deadlock_signal()
 };
 
 template <class E>
@@ -44,6 +88,11 @@ constexpr std::underlying_type_t<E> to_underlying(E e) noexcept {
     return static_cast<std::underlying_type_t<E>>(e);
 }
 
+// Action moving in the opposite direction
+constexpr auto opposite_action(Action action) noexcept -> Action {
+    return static_cast<Action>((to_underlying(action) + 2) % kNumActions);
+}
+
 // actions to strings
 const std::unordered_map<Action, std::string> kActionToString{
     {Action::kUp, "up"},
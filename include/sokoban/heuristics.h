@@ -0,0 +1,110 @@
+#ifndef SOKOBAN_HEURISTICS_H_
+#define SOKOBAN_HEURISTICS_H_
+
+#include <sokoban/sokoban_base.h>
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace sokoban {
+
+// Heuristic value for states which can't be solved, such states are pruned from the search
+constexpr int kInfiniteCost = std::numeric_limits<int>::max();
+
+// Estimate of the number of pushes left to solve a state, or kInfiniteCost if the state can't be solved.
+// Should be admissible (never overestimate) for solutions to be push optimal.
+using Heuristic = std::function<int(const SokobanGameState&)>;
+
+/**
+ * Sum over all boxes of the manhattan distance to the closest goal.
+ * Each push moves one box by one cell, so this is an admissible and consistent estimate of the remaining pushes.
+ * @param state State to evaluate
+ * @return Lower bound on the number of pushes left
+ */
+[[nodiscard]] auto manhattan_heuristic(const SokobanGameState& state) -> int;
+
+/**
+ * Sum over all boxes of the push distance to the closest goal, see Level::get_push_distance().
+ * Boxes greedily take their closest goal even if another box takes the same one, which keeps it admissible.
+ * @param state State to evaluate
+ * @return Lower bound on the number of pushes left, or kInfiniteCost if a box can't reach any goal
+ */
+[[nodiscard]] auto greedy_heuristic(const SokobanGameState& state) -> int;
+
+/**
+ * Minimum cost matching of boxes to distinct goals, with push distances as costs.
+ * Never lower than greedy_heuristic(), and still admissible as every box has to end on its own goal.
+ * @param state State to evaluate
+ * @return Lower bound on the number of pushes left, or kInfiniteCost if no matching exists
+ */
+[[nodiscard]] auto matching_heuristic(const SokobanGameState& state) -> int;
+
+// Incremental version of matching_heuristic().
+// The matching is solved with the Hungarian algorithm, and the row potentials, column potentials, and assignment are
+// kept between calls. A push only changes the cost row of one box, so after a push only that box is unassigned and
+// matched again with one augmenting path search, O(n^2) instead of O(n^3) for n boxes.
+// Buffers are reused between calls, so one instance per search thread avoids allocations.
+class MatchingHeuristic {
+public:
+    /**
+     * Solve the matching of the given state from scratch.
+     * @param state State to evaluate, its level must outlive later move_box() and evaluate_move() calls
+     * @return Matching cost, or kInfiniteCost if no matching exists
+     */
+    auto reset(const SokobanGameState& state) -> int;
+
+    /**
+     * Get the matching cost after moving one box, leaving the current matching unchanged.
+     * Used to evaluate all successors of a state from the state's matching.
+     * @param box_cell Cell of the box before the move, must hold a box
+     * @param box_new_cell Cell of the box after the move
+     * @return Matching cost after the move, or kInfiniteCost if no matching exists
+     * @throws std::invalid_argument if there is no box on box_cell or box_new_cell is off the board
+     */
+    [[nodiscard]] auto evaluate_move(int box_cell, int box_new_cell) -> int;
+
+    /**
+     * Update the matching after moving one box.
+     * @param box_cell Cell of the box before the move, must hold a box
+     * @param box_new_cell Cell of the box after the move
+     * @return Matching cost after the move, or kInfiniteCost if no matching exists
+     * @throws std::invalid_argument if there is no box on box_cell or box_new_cell is off the board
+     */
+    auto move_box(int box_cell, int box_new_cell) -> int;
+
+    /**
+     * Get the matching cost, as of the last reset() or move_box().
+     * @return Matching cost, or kInfiniteCost if no matching exists
+     */
+    [[nodiscard]] auto get_cost() const noexcept -> int;
+
+private:
+    // Hungarian algorithm state, rows are boxes and columns goals, both 1-indexed with index 0 as the free marker
+    struct Matching {
+        std::vector<int> box_cells;    // Row to box cell
+        std::vector<int> costs;        // (rows + 1) * (cols + 1), row major
+        std::vector<int> row_potential;
+        std::vector<int> col_potential;
+        std::vector<int> col_match;    // Column to matched row, 0 if free
+    };
+
+    void SetRow(Matching& matching, int row, int box_cell) const noexcept;
+    void AssignRow(Matching& matching, int row);
+    [[nodiscard]] auto Cost(const Matching& matching) const noexcept -> int;
+    auto MoveBox(Matching& matching, int box_cell, int box_new_cell) -> int;
+
+    const Level* level = nullptr;
+    int num_rows = 0;
+    int num_cols = 0;
+    int unreachable_cost = 0;
+    Matching current;
+    Matching scratch;
+    std::vector<int> min_slack;
+    std::vector<int> way;
+    std::vector<bool> used;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_HEURISTICS_H_
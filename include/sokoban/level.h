@@ -0,0 +1,205 @@
+#ifndef SOKOBAN_LEVEL_H_
+#define SOKOBAN_LEVEL_H_
+
+#include <sokoban/bitboard.h>
+#include <sokoban/definitions.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace sokoban {
+
+// Immutable level data shared by all states of the same level.
+// Only dynamic elements (agent, boxes) live in SokobanGameState, so copying a state never touches the static board.
+class Level {
+public:
+    Level() = delete;
+    Level(int rows, int cols, std::vector<Element> board_static);
+
+    auto operator==(const Level& other) const noexcept -> bool;
+    auto operator!=(const Level& other) const noexcept -> bool;
+
+    /**
+     * Get the number of rows in the level.
+     * @return Row count
+     */
+    [[nodiscard]] auto get_rows() const noexcept -> int {
+        return rows;
+    }
+
+    /**
+     * Get the number of columns in the level.
+     * @return Column count
+     */
+    [[nodiscard]] auto get_cols() const noexcept -> int {
+        return cols;
+    }
+
+    /**
+     * Get the number of cells in the level.
+     * @return rows * cols
+     */
+    [[nodiscard]] auto get_flat_size() const noexcept -> int {
+        return rows * cols;
+    }
+
+    /**
+     * Get the static board, where each cell is one of wall, goal, or empty.
+     * @return Flat static board
+     */
+    [[nodiscard]] auto get_board_static() const noexcept -> const std::vector<Element>& {
+        return board_static;
+    }
+
+    /**
+     * Get the static element at the given index.
+     * @param index Flat index of the cell
+     * @return Element, one of wall, goal, or empty
+     */
+    [[nodiscard]] auto get_element(int index) const noexcept -> Element {
+        return board_static[static_cast<std::size_t>(index)];
+    }
+
+    /**
+     * Check if the given cell is a wall.
+     * @param index Flat index of the cell
+     * @return True if wall, false otherwise
+     */
+    [[nodiscard]] auto is_wall(int index) const noexcept -> bool {
+        return get_element(index) == Element::kWall;
+    }
+
+    /**
+     * Check if the given cell is a goal.
+     * @param index Flat index of the cell
+     * @return True if goal, false otherwise
+     */
+    [[nodiscard]] auto is_goal(int index) const noexcept -> bool {
+        return get_element(index) == Element::kGoal;
+    }
+
+    /**
+     * Get all indices of goals, in increasing order.
+     * @return vector of indicies
+     */
+    [[nodiscard]] auto get_goal_indices() const noexcept -> const std::vector<int>& {
+        return goal_indices;
+    }
+
+    /**
+     * Get the cell reached by moving one step from the given cell in the direction of the action.
+     * @param index Flat index of the cell
+     * @param action Direction to move
+     * @return Flat index of the neighbour, or kNoCell if it is off the board or a wall
+     */
+    [[nodiscard]] auto get_neighbour(int index, Action action) const noexcept -> int {
+        return neighbours[(static_cast<std::size_t>(index) * kNumActions) + static_cast<std::size_t>(action)];
+    }
+
+    /**
+     * Get the Zobrist key for the agent standing on the given cell.
+     * @param index Flat index of the cell
+     * @return Hash key
+     */
+    [[nodiscard]] auto get_agent_key(int index) const noexcept -> uint64_t {
+        return agent_keys[static_cast<std::size_t>(index)];
+    }
+
+    /**
+     * Get the Zobrist key for a box on the given cell.
+     * @param index Flat index of the cell
+     * @return Hash key
+     */
+    [[nodiscard]] auto get_box_key(int index) const noexcept -> uint64_t {
+        return box_keys[static_cast<std::size_t>(index)];
+    }
+
+    /**
+     * Get the hash contribution of the static board, which every state of this level shares.
+     * @return Hash value
+     */
+    [[nodiscard]] auto get_static_hash() const noexcept -> uint64_t {
+        return static_hash;
+    }
+
+    /**
+     * Get the mask of all goal cells.
+     * @return Bitboard with goal cells set
+     */
+    [[nodiscard]] auto get_goal_mask() const noexcept -> const BoardBitboard& {
+        return goal_mask;
+    }
+
+    /**
+     * Get the mask of all wall cells.
+     * @return Bitboard with wall cells set
+     */
+    [[nodiscard]] auto get_wall_mask() const noexcept -> const BoardBitboard& {
+        return wall_mask;
+    }
+
+    /**
+     * Get the mask of all cells on the board, i.e. the first rows * cols bits.
+     * @return Bitboard with board cells set
+     */
+    [[nodiscard]] auto get_board_mask() const noexcept -> const BoardBitboard& {
+        return board_mask;
+    }
+
+    /**
+     * Get the minimum number of pushes to move a box from the given cell to a goal, ignoring all other boxes.
+     * Computed once per level by pulling a box backwards from the goal, so it is a lower bound for any state.
+     * @param goal Position of the goal in get_goal_indices()
+     * @param index Flat index of the cell
+     * @return Number of pushes, or kUnreachable if the box can't be pushed to the goal
+     */
+    [[nodiscard]] auto get_push_distance(int goal, int index) const noexcept -> int {
+        return push_distances[(static_cast<std::size_t>(goal) * board_static.size()) + static_cast<std::size_t>(index)];
+    }
+
+    /**
+     * Get the minimum number of pushes to move a box from the given cell to its closest goal, see get_push_distance().
+     * @param index Flat index of the cell
+     * @return Number of pushes, or kUnreachable if no goal can be reached
+     */
+    [[nodiscard]] auto get_closest_goal_distance(int index) const noexcept -> int {
+        return closest_goal_distances[static_cast<std::size_t>(index)];
+    }
+
+    /**
+     * Get the mask of dead squares, floor cells from which a box can never be pushed to any goal.
+     * @return Bitboard with dead cells set
+     */
+    [[nodiscard]] auto get_dead_mask() const noexcept -> const BoardBitboard& {
+        return dead_mask;
+    }
+
+    /**
+     * Check if a box on the given cell can never reach a goal.
+     * @param index Flat index of the cell
+     * @return True if dead square, false otherwise
+     */
+    [[nodiscard]] auto is_dead_square(int index) const noexcept -> bool {
+        return dead_mask.test(index);
+    }
+
+private:
+    int rows = -1;
+    int cols = -1;
+    std::vector<Element> board_static;
+    std::vector<int> goal_indices;
+    std::vector<int> neighbours;    // flat_size * kNumActions, indexed by cell then action
+    std::vector<uint64_t> agent_keys;
+    std::vector<uint64_t> box_keys;
+    std::vector<int> push_distances;            // num_goals * flat_size, indexed by goal then cell
+    std::vector<int> closest_goal_distances;    // flat_size
+    uint64_t static_hash = 0;
+    BoardBitboard goal_mask;
+    BoardBitboard wall_mask;
+    BoardBitboard board_mask;
+    BoardBitboard dead_mask;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_LEVEL_H_
@@ -0,0 +1,107 @@
+#ifndef SOKOBAN_LEVEL_STORE_H_
+#define SOKOBAN_LEVEL_STORE_H_
+
+#include <sokoban/sokoban_base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sokoban {
+
+// Levels parsed once and stored back to back as one byte per cell, so large level sets (such as the Boxoban files,
+// one board string per line) load in a single pass and states are made by index without parsing again.
+// Levels are validated when added, so making a state of a stored level only fails if the level itself is invalid.
+class LevelStore {
+public:
+    LevelStore() = default;
+
+    /**
+     * Load all levels of a file, one board string per line. Empty lines are skipped.
+     * @param path Path of the file
+     * @return Store holding the levels in file order
+     * @throws std::invalid_argument if the file can't be read or a level is invalid, naming the line
+     */
+    [[nodiscard]] static auto from_file(const std::string& path) -> LevelStore;
+
+    /**
+     * Load all levels of a text, one board string per line. Empty lines are skipped.
+     * @param text Board strings separated by newlines
+     * @return Store holding the levels in text order
+     * @throws std::invalid_argument if a level is invalid, naming the line
+     */
+    [[nodiscard]] static auto from_string(std::string_view text) -> LevelStore;
+
+    /**
+     * Parse, validate, and append a level.
+     * @param board_str Board string, see SokobanGameState(const std::string&)
+     * @throws std::invalid_argument if the level is invalid, the store is left unchanged
+     */
+    void add(std::string_view board_str);
+
+    /**
+     * Get the number of stored levels.
+     * @return Level count
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /**
+     * Get the number of rows of a level.
+     * @param index Index of the level
+     * @return Row count
+     */
+    [[nodiscard]] auto get_rows(std::size_t index) const -> int;
+
+    /**
+     * Get the number of columns of a level.
+     * @param index Index of the level
+     * @return Column count
+     */
+    [[nodiscard]] auto get_cols(std::size_t index) const -> int;
+
+    /**
+     * Get the element codes of a level, valid until the next level is added.
+     * @param index Index of the level
+     * @return rows * cols element codes in row major order
+     */
+    [[nodiscard]] auto get_codes(std::size_t index) const -> std::span<const uint8_t>;
+
+    /**
+     * Make the initial state of a level.
+     * @param index Index of the level
+     * @return State of the level
+     * @throws std::out_of_range if the index is out of range
+     */
+    [[nodiscard]] auto get_state(std::size_t index) const -> SokobanGameState;
+
+    /**
+     * Make the initial states of all levels, for example as the level pool of a SokobanVecEnv.
+     * @return States in store order
+     */
+    [[nodiscard]] auto get_states() const -> std::vector<SokobanGameState>;
+
+    /**
+     * Get the memory used by the stored levels.
+     * @return Bytes
+     */
+    [[nodiscard]] auto get_memory_bytes() const noexcept -> std::size_t;
+
+private:
+    struct Entry {
+        std::size_t offset;
+        uint16_t rows;
+        uint16_t cols;
+    };
+
+    [[nodiscard]] auto GetEntry(std::size_t index) const -> const Entry&;
+
+    std::vector<uint8_t> codes;
+    std::vector<Entry> entries;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_LEVEL_STORE_H_
@@ -0,0 +1,163 @@
+#ifndef SOKOBAN_MCTS_H_
+#define SOKOBAN_MCTS_H_
+
+#include <sokoban/definitions.h>
+#include <sokoban/sokoban_base.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sokoban {
+
+class ThreadPool;
+
+/**
+ * Evaluates a batch of leaf states for MCTS.
+ * @param observations count observations written back to back, each laid out as SokobanGameState::observation_shape()
+ * @param count Number of leaves in the batch
+ * @param priors Output of count * kNumActions non-negative action weights, normalized over legal actions by the search
+ * @param values Output of count leaf values, typically in [-1, 1]
+ */
+using LeafEvaluator =
+    std::function<void(const float* observations, std::size_t count, float* priors, float* values)>;
+
+struct MCTSOptions {
+    // Number of simulations per search, each ending in an evaluated or terminal leaf
+    int num_simulations = 800;
+    // Maximum number of leaves selected before each evaluator call
+    int batch_size = 8;
+    // Number of threads selecting leaves and writing their observations
+    int num_threads = 1;
+    // Exploration constant of the PUCT rule
+    float c_puct = 1.25F;
+    // Value subtracted from the nodes on the path of a leaf awaiting evaluation, so other selections of the same
+    // batch are steered to different leaves
+    float virtual_loss = 1.0F;
+    // Factor applied to a child's value per action, below 1 to prefer shorter solutions
+    float discount = 1.0F;
+    // Value of solved states
+    float solved_value = 1.0F;
+    // Value of deadlocked states and states without legal actions
+    float deadlock_value = -1.0F;
+    // End simulations at states where the last push deadlocked a box, see SokobanGameState::is_box_deadlocked()
+    bool terminate_deadlocks = true;
+    // Write compact observations, see SokobanGameState::observation_shape()
+    bool compact = true;
+};
+
+struct MCTSResult {
+    // Visits of each root action
+    std::array<int, kNumActions> visit_counts{};
+    // Mean discounted value of each root action, 0 for actions never visited
+    std::array<float, kNumActions> q_values{};
+    // Mean value of the root over all simulations
+    float root_value = 0;
+    // Most visited root action, ties broken by the higher value
+    Action best_action = Action::kUp;
+    int num_simulations = 0;        // Simulations run
+    int num_evaluations = 0;        // Leaves passed to the evaluator
+    int num_batches = 0;            // Evaluator calls
+    int num_collisions = 0;         // Selections dropped as their leaf was already awaiting evaluation
+    int max_depth = 0;              // Deepest leaf reached
+    std::size_t num_nodes = 0;      // Nodes allocated in the tree
+};
+
+// Monte Carlo tree search with the PUCT selection rule of AlphaZero, over single steps of the agent.
+// Leaves are collected in batches: selections run in parallel under virtual loss, their observations are written to
+// one contiguous buffer, and a single evaluator call returns priors and values for the whole batch. Nodes live in an
+// arena which is sized once per search and kept between searches, so a search performs no per-node allocation.
+class MCTS {
+public:
+    /**
+     * @param options Search parameters
+     * @throws std::invalid_argument if a count is not positive or the discount is outside (0, 1]
+     */
+    explicit MCTS(const MCTSOptions& options = {});
+    ~MCTS();
+
+    MCTS(const MCTS&) = delete;
+    MCTS(MCTS&&) noexcept;
+    auto operator=(const MCTS&) -> MCTS& = delete;
+    auto operator=(MCTS&&) noexcept -> MCTS&;
+
+    /**
+     * Run a full search from the given state. The evaluator is always called from the calling thread.
+     * @param state Root state
+     * @param evaluator Evaluator of leaf observations
+     * @return Root action statistics and search counters
+     */
+    auto search(const SokobanGameState& state, const LeafEvaluator& evaluator) -> MCTSResult;
+
+    /**
+     * Get the search parameters.
+     * @return Options given at construction
+     */
+    [[nodiscard]] auto get_options() const noexcept -> const MCTSOptions&;
+
+    /**
+     * Get the number of nodes the arena holds without growing.
+     * @return Arena capacity
+     */
+    [[nodiscard]] auto get_arena_capacity() const noexcept -> std::size_t;
+
+private:
+    enum class Terminal : uint8_t {
+        kNone = 0,
+        kSolved = 1,
+        kDeadlocked = 2,
+    };
+
+    // Children of a node are allocated together, one per action, starting at first_child
+    struct Node {
+        std::atomic<int32_t> visits{0};
+        std::atomic<float> value_sum{0};
+        std::atomic<bool> pending{false};    // Selected as a leaf in the current batch
+        float prior = 0;
+        int32_t first_child = -1;            // -1 while not expanded
+        uint8_t legal_mask = 0;              // Bit per action
+        Terminal terminal = Terminal::kNone;
+    };
+
+    enum class LeafKind : uint8_t {
+        kCollision = 0,
+        kTerminal = 1,
+        kEvaluate = 2,
+    };
+
+    // One selection of a batch, from the root down to a leaf
+    struct Selection {
+        std::vector<int32_t> path;
+        LeafKind kind = LeafKind::kCollision;
+        Terminal terminal = Terminal::kNone;
+        uint8_t legal_mask = 0;
+        std::size_t eval_index = 0;    // Position of the leaf in the evaluator batch
+    };
+
+    void InitNode(std::size_t index, float prior) noexcept;
+    void Select(const SokobanGameState& root, Selection& selection, float* observation);
+    [[nodiscard]] auto SelectChild(const Node& node) const noexcept -> int;
+    void Expand(const Selection& selection, const float* leaf_priors) noexcept;
+    void Backup(const Selection& selection, float value) noexcept;
+    void RevertVirtualLoss(const Selection& selection) noexcept;
+    [[nodiscard]] auto Classify(const SokobanGameState& state, int pushed_box) const noexcept -> Terminal;
+    [[nodiscard]] auto TerminalValue(Terminal terminal) const noexcept -> float;
+
+    MCTSOptions options;
+    // Only selection runs on several threads, expansion and backup run on the calling thread between batches
+    std::vector<Node> nodes;
+    std::size_t num_nodes = 0;
+    std::vector<Selection> selections;
+    std::vector<float> observations;
+    std::vector<float> priors;
+    std::vector<float> values;
+    std::unique_ptr<ThreadPool> thread_pool;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_MCTS_H_
@@ -0,0 +1,47 @@
+#ifndef SOKOBAN_OBSERVATION_CACHE_H_
+#define SOKOBAN_OBSERVATION_CACHE_H_
+
+#include <sokoban/bitboard.h>
+#include <sokoban/level.h>
+#include <sokoban/sokoban_base.h>
+
+#include <memory>
+#include <vector>
+
+namespace sokoban {
+
+// Observation tensor kept alongside a state and updated incrementally.
+// A step changes at most three cells (agent old/new, box new), so after the first full build only the cells whose
+// agent/box occupancy differs from the last synced state are rewritten. Works for any sequence of states, the
+// tensor is rebuilt in full whenever the level changes.
+class ObservationCache {
+public:
+    /**
+     * @param compact True to use compact representation, see SokobanGameState::observation_shape
+     */
+    explicit ObservationCache(bool compact = true);
+
+    /**
+     * Bring the cached observation in sync with the given state.
+     * @param state State to observe
+     * @return Flat observation, same as state.get_observation(compact)
+     */
+    auto update(const SokobanGameState& state) -> const std::vector<float>&;
+
+    /**
+     * Get the cached observation as of the last update.
+     * @return Flat observation
+     */
+    [[nodiscard]] auto get_observation() const noexcept -> const std::vector<float>&;
+
+private:
+    std::shared_ptr<const Level> level;
+    int agent_idx = -1;
+    BoardBitboard boxes;
+    bool compact;
+    std::vector<float> obs;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_OBSERVATION_CACHE_H_
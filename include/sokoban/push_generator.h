@@ -0,0 +1,99 @@
+#ifndef SOKOBAN_PUSH_GENERATOR_H_
+#define SOKOBAN_PUSH_GENERATOR_H_
+
+#include <sokoban/bitboard.h>
+#include <sokoban/definitions.h>
+#include <sokoban/sokoban_base.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sokoban {
+
+// A box push, the agent walks to agent_cell and then moves in direction, moving the box off box_cell
+struct PushMove {
+    int agent_cell = kNoCell;
+    int box_cell = kNoCell;
+    Action direction = Action::kUp;
+};
+
+// Push level successor generator.
+// The region the agent can walk to without pushing is flood filled into a bitboard, and only box pushes from
+// that region are emitted as successors. States whose boxes match and whose agents are in the same region are the
+// same node for push search, canonical_key() identifies them by normalizing the agent to the region's minimum cell.
+// Buffers are reused between calls, so one generator per search thread avoids allocations.
+class PushGenerator {
+public:
+    /**
+     * Compute the reachable region and all pushes of the given state.
+     * @param state State to generate pushes for
+     */
+    void generate(const SokobanGameState& state);
+
+    /**
+     * Get the cells the agent can walk to without pushing, as of the last generate().
+     * @return Reachable cells, including the agent cell
+     */
+    [[nodiscard]] auto get_reachable() const noexcept -> const BoardBitboard& {
+        return reachable;
+    }
+
+    /**
+     * Get the pushes available, as of the last generate().
+     * @return Push moves, grouped by direction
+     */
+    [[nodiscard]] auto get_pushes() const noexcept -> const std::vector<PushMove>& {
+        return pushes;
+    }
+
+    /**
+     * Get the canonical key of the state from the last generate(), see canonical_key(state).
+     * @return Canonical key
+     */
+    [[nodiscard]] auto get_canonical_key() const noexcept -> uint64_t {
+        return key;
+    }
+
+    /**
+     * Append the shortest walk from the agent to a reachable cell, as of the last generate() or canonical_key() call.
+     * The agent cell and reachable region are the ones recorded by that call, so the state may have changed or been
+     * destroyed since.
+     * @param target_cell Cell to walk to, should be in get_reachable()
+     * @param actions Output actions, the walk is appended
+     * @throws std::invalid_argument if the target cell is not reachable
+     */
+    void append_walk(int target_cell, std::vector<Action>& actions);
+
+    /**
+     * Append the full primitive action sequence of a push, the walk to the push cell followed by the push.
+     * @param push Push from get_pushes()
+     * @param actions Output actions, the walk and push are appended
+     */
+    void append_push_actions(const PushMove& push, std::vector<Action>& actions);
+
+    /**
+     * Get the key of a state with the agent moved to the minimum cell of its reachable region.
+     * States with the same boxes and the agent in the same region share the same key.
+     * @param state State to get the key of
+     * @return Canonical key
+     */
+    [[nodiscard]] auto canonical_key(const SokobanGameState& state) -> uint64_t;
+
+private:
+    void FloodFill(const SokobanGameState& state);
+
+    // Level and agent cell of the last flood fill, walks start from them. The level is shared so walks outlive the
+    // state, it is only reassigned when the level changes to keep refcounting out of searches.
+    std::shared_ptr<const Level> walk_level;
+    int walk_start = kNoCell;
+    BoardBitboard reachable;
+    uint64_t key = 0;
+    std::vector<PushMove> pushes;
+    std::vector<int> entered_by;
+    std::vector<int> queue;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_PUSH_GENERATOR_H_
@@ -0,0 +1,64 @@
+#ifndef SOKOBAN_RENDERER_H_
+#define SOKOBAN_RENDERER_H_
+
+#include <sokoban/bitboard.h>
+#include <sokoban/definitions.h>
+#include <sokoban/level.h>
+#include <sokoban/sokoban_base.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sokoban {
+
+// Image of a state kept between frames, for rendering every step of an episode.
+// The static walls/goals background is drawn once per level, after which only the tiles whose agent/box occupancy
+// differs from the last rendered state are redrawn. Works for any sequence of states, the background and image are
+// rebuilt whenever the level changes.
+class Renderer {
+public:
+    /**
+     * @param tile_size Pixels per side of each board tile
+     * @param grayscale True for a single luma channel, RGB otherwise
+     */
+    explicit Renderer(TileSize tile_size = TileSize::k32, bool grayscale = false);
+
+    /**
+     * Render the given state.
+     * @param state State to render
+     * @return Flat (HWC) image, same as state.to_image(tile_size, grayscale)
+     */
+    auto render(const SokobanGameState& state) -> const std::vector<uint8_t>&;
+
+    /**
+     * Get the image as of the last render.
+     * @return Flat (HWC) image
+     */
+    [[nodiscard]] auto get_image() const noexcept -> const std::vector<uint8_t>&;
+
+    /**
+     * Get the tile size images are rendered with.
+     * @return Pixels per side of each board tile
+     */
+    [[nodiscard]] auto get_tile_size() const noexcept -> TileSize;
+
+    /**
+     * Check if images are rendered in grayscale.
+     * @return True for a single luma channel, false for RGB
+     */
+    [[nodiscard]] auto is_grayscale() const noexcept -> bool;
+
+private:
+    TileSize tile_size;
+    bool grayscale;
+    std::shared_ptr<const Level> level;
+    int agent_idx = -1;
+    BoardBitboard boxes;
+    std::vector<uint8_t> background;
+    std::vector<uint8_t> image;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_RENDERER_H_
@@ -0,0 +1,154 @@
+#ifndef SOKOBAN_SERIALIZATION_H_
+#define SOKOBAN_SERIALIZATION_H_
+
+#include <sokoban/sokoban_base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sokoban {
+
+// Version written into serialized states and archives, readers reject other versions
+constexpr uint8_t kSerializationVersion = 1;
+
+// Binary state format, all integers little endian:
+//   4 bytes   magic "SKBS"
+//   1 byte    version
+//   1 byte    flags, bit 0 set if the deadlock signal is enabled
+//   2 bytes   rows
+//   2 bytes   cols
+//   2 bytes   agent index
+//   2 bytes   number of boxes
+//   2 bytes   reserved, zero
+//   8 bytes   reward signal
+//   8 bytes   hash
+//   static board, 2 bits per cell in row major order (0 empty, 1 wall, 2 goal), padded to a whole byte
+//   boxes, 1 bit per cell in row major order, padded to a whole byte
+
+/**
+ * Get the number of bytes serialize() writes for a state.
+ * @param state State to serialize
+ * @return Size in bytes, only depends on the dimensions of the level
+ */
+[[nodiscard]] auto serialized_size(const SokobanGameState& state) noexcept -> std::size_t;
+
+/**
+ * Write the binary representation of a state into a caller provided buffer, without allocating.
+ * @param state State to serialize
+ * @param out Buffer with room for serialized_size(state) bytes
+ */
+void serialize(const SokobanGameState& state, uint8_t* out) noexcept;
+
+/**
+ * Append the binary representation of a state.
+ * @param state State to serialize
+ * @param out Bytes are appended to this
+ */
+void serialize(const SokobanGameState& state, std::vector<uint8_t>& out);
+
+/**
+ * Get the binary representation of a state.
+ * @param state State to serialize
+ * @return Serialized bytes
+ */
+[[nodiscard]] auto serialize(const SokobanGameState& state) -> std::vector<uint8_t>;
+
+/**
+ * Make a state from its binary representation.
+ * @param data Bytes written by serialize(), trailing bytes are not allowed
+ * @return The state, equal to the serialized state including its hash and signals
+ * @throws std::invalid_argument if the data is truncated, of another version, or doesn't describe a valid state
+ */
+[[nodiscard]] auto deserialize(std::span<const uint8_t> data) -> SokobanGameState;
+
+/**
+ * Serialize states into consecutive records of equal size, so a batch of states is one buffer.
+ * @param states States to serialize, all with the same rows and cols
+ * @param out Buffer with room for states.size() * serialized_size(states.front()) bytes
+ * @throws std::invalid_argument if the states differ in rows or cols, nothing is written then
+ */
+void serialize_batch(std::span<const SokobanGameState> states, uint8_t* out);
+
+/**
+ * Make states from consecutive records written by serialize_batch().
+ * Consecutive states of the same level share one Level, so a batch of one level is much cheaper than
+ * deserializing its states one by one.
+ * @param data Records back to back
+ * @param record_size Size of each record, serialized_size() of the states
+ * @return States in record order
+ * @throws std::invalid_argument if the data isn't a whole number of records or a record is invalid
+ */
+[[nodiscard]] auto deserialize_batch(std::span<const uint8_t> data, std::size_t record_size)
+    -> std::vector<SokobanGameState>;
+
+class MappedFile;
+
+// File of serialized states which is memory mapped when opened, so only the states accessed are read from disk and
+// processes opening the same file share its pages. Layout, all integers little endian:
+//   4 bytes   magic "SKBA"
+//   1 byte    version
+//   3 bytes   reserved, zero
+//   8 bytes   number of states N
+//   8 bytes   N + 1 offsets of the states, relative to the end of the offsets, the last is the total size
+//   states in the format of serialize()
+class StateArchive {
+public:
+    /**
+     * Write states to an archive file, replacing the file if it exists.
+     * @param path Path of the file
+     * @param states States to write
+     * @throws std::invalid_argument if the file can't be written
+     */
+    static void write(const std::string& path, std::span<const SokobanGameState> states);
+
+    /**
+     * Open and map an archive file.
+     * @param path Path of the file
+     * @throws std::invalid_argument if the file can't be mapped or isn't an archive of the current version
+     */
+    explicit StateArchive(const std::string& path);
+    ~StateArchive();
+
+    StateArchive(const StateArchive&) = delete;
+    StateArchive(StateArchive&&) noexcept;
+    auto operator=(const StateArchive&) -> StateArchive& = delete;
+    auto operator=(StateArchive&&) noexcept -> StateArchive&;
+
+    /**
+     * Get the number of states in the archive.
+     * @return State count
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /**
+     * Get the serialized bytes of a state, valid while the archive is open.
+     * @param index Index of the state
+     * @return Bytes in the format of serialize()
+     * @throws std::out_of_range if the index is out of range
+     */
+    [[nodiscard]] auto get_bytes(std::size_t index) const -> std::span<const uint8_t>;
+
+    /**
+     * Read a state.
+     * @param index Index of the state
+     * @return The state
+     * @throws std::out_of_range if the index is out of range
+     * @throws std::invalid_argument if the stored state is invalid
+     */
+    [[nodiscard]] auto get_state(std::size_t index) const -> SokobanGameState;
+
+private:
+    std::unique_ptr<MappedFile> file;
+    std::size_t num_states = 0;
+    const uint8_t* offsets = nullptr;
+    const uint8_t* states = nullptr;
+    std::size_t states_size = 0;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_SERIALIZATION_H_
@@ -1,7 +1,20 @@
 #ifndef SOKOBAN_H
 #define SOKOBAN_H
 
+#include <sokoban/bitboard.h>
 #include <sokoban/definitions.h>
+#include <sokoban/heuristics.h>
+#include <sokoban/level.h>
+#include <sokoban/level_store.h>
+#include <sokoban/mcts.h>
+#include <sokoban/observation_cache.h>
+#include <sokoban/push_generator.h>
+#include <sokoban/renderer.h>
+#include <sokoban/serialization.h>
 #include <sokoban/sokoban_base.h>
+#include <sokoban/solver.h>
+#include <sokoban/state_pool.h>
+#include <sokoban/transposition_table.h>
+#include <sokoban/vec_env.h>
 
 #endif    // SOKOBAN_H
@@ -1,14 +1,19 @@
 #ifndef SOKOBAN_BASE_H_
 #define SOKOBAN_BASE_H_
 
+#include <sokoban/bitboard.h>
 #include <sokoban/definitions.h>
+#include <sokoban/level.h>
 
 #include <array>
 #include <cstdint>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace sokoban {
@@ -19,6 +24,14 @@ constexpr int SPRITE_CHANNELS = 3;
 constexpr int SPRITE_DATA_LEN_PER_ROW = SPRITE_WIDTH * SPRITE_CHANNELS;
 constexpr int SPRITE_DATA_LEN = SPRITE_WIDTH * SPRITE_HEIGHT * SPRITE_CHANNELS;
 
+// Everything an action changes, so SokobanGameState::undo_action() can restore the state exactly
+struct UndoRecord {
+    int agent_index = kNoCell;     // Agent position before the action
+    int box_from = kNoCell;        // Cell of the box pushed by the action, kNoCell if no box moved
+    int box_to = kNoCell;          // Cell the box was pushed to
+    uint64_t reward_signal = 0;    // Reward signal before the action
+};
+
 // Game state
 class SokobanGameState {
 public:
@@ -31,12 +44,24 @@ public:
         uint64_t reward_signal;
         std::vector<int> board_static;
         std::vector<bool> is_box;
+        bool deadlock_signal = false;
+        // Level to share instead of building one from board_static, which is then ignored. Must be the same board.
+        std::shared_ptr<const Level> level;
     };
 
     SokobanGameState() = delete;
     SokobanGameState(const std::string& board_str);
     SokobanGameState(InternalState&& internal_state);
 
+    /**
+     * Construct from already split element codes, as stored by LevelStore.
+     * @param rows Number of rows
+     * @param cols Number of columns
+     * @param codes rows * cols element codes in row major order, same codes as in board strings
+     * @throws std::invalid_argument if the size or codes don't describe a valid level
+     */
+    SokobanGameState(int rows, int cols, std::span<const uint8_t> codes);
+
     auto operator==(const SokobanGameState& other) const noexcept -> bool;
     auto operator!=(const SokobanGameState& other) const noexcept -> bool;
 
@@ -57,6 +82,50 @@ public:
      */
     void apply_action(Action action);
 
+    /**
+     * Apply a push as a single macro move: the agent is placed on agent_cell and then moves in direction.
+     * Equivalent to walking to agent_cell and then applying the action, see PushGenerator for the walk.
+     * @param agent_cell Cell the agent pushes from, should be reachable by the agent without pushing a box
+     * @param action Direction to push in, should be one of the legal actions
+     */
+    void apply_push(int agent_cell, Action action);
+
+    /**
+     * Apply the action like apply_action(), and return what is needed to take it back.
+     * Lets searches run on one mutable state instead of copying it per child.
+     * @param action The action to apply, should be one of the legal actions
+     * @return Record to pass to undo_action()
+     */
+    [[nodiscard]] auto apply_action_undoable(Action action) -> UndoRecord;
+
+    /**
+     * Apply the push like apply_push(), and return what is needed to take it back.
+     * @param agent_cell Cell the agent pushes from, should be reachable by the agent without pushing a box
+     * @param action Direction to push in, should be one of the legal actions
+     * @return Record to pass to undo_action()
+     */
+    [[nodiscard]] auto apply_push_undoable(int agent_cell, Action action) -> UndoRecord;
+
+    /**
+     * Take back an action, restoring agent, boxes, hash, and reward signal to what they were before it.
+     * Records must be undone in reverse order of the actions, starting from the most recent.
+     * @param undo Record returned by the most recent apply_action_undoable() or apply_push_undoable() not yet undone
+     */
+    void undo_action(const UndoRecord& undo) noexcept;
+
+    /**
+     * Get the actions which change the state, either walking onto a free cell or pushing a box onto a free cell.
+     * Other actions walk into a wall or an unpushable box and leave the state unchanged.
+     * @return Mask with bit a set if action a changes the state
+     */
+    [[nodiscard]] auto legal_action_mask() const noexcept -> uint8_t;
+
+    /**
+     * Get the legal actions which push a box, a subset of legal_action_mask().
+     * @return Mask with bit a set if action a pushes a box
+     */
+    [[nodiscard]] auto push_action_mask() const noexcept -> uint8_t;
+
     /**
      * Get the number of possible actions
      * @return Count of possible actions
@@ -71,6 +140,35 @@ public:
      */
     [[nodiscard]] auto is_solution() const noexcept -> bool;
 
+    /**
+     * Check if the state can no longer be solved because of a box deadlock.
+     * Detects boxes off goal on dead squares of the level, and freeze deadlocks where a group of boxes blocks each
+     * other against walls (including the 2x2 square). Never reports a solvable state as deadlocked, but not every
+     * unsolvable state is detected.
+     * @return True if a deadlock was found, false otherwise
+     */
+    [[nodiscard]] auto is_deadlocked() const noexcept -> bool;
+
+    /**
+     * Check for deadlocks involving a single box, cheaper than is_deadlocked() when only one box moved.
+     * @param box_index Flat index of the box, typically the box just pushed
+     * @return True if the box is on a dead square or part of a frozen group with a box off goal
+     */
+    [[nodiscard]] auto is_box_deadlocked(int box_index) const noexcept -> bool;
+
+    /**
+     * Enable setting kRewardDeadlock in the reward signal when a push results in a deadlock of the pushed box.
+     * Disabled by default, as the check adds a small cost to every push.
+     * @param enabled True to enable the deadlock signal
+     */
+    void set_deadlock_signal(bool enabled) noexcept;
+
+    /**
+     * Check if the deadlock reward signal is enabled.
+     * @return True if enabled, false otherwise
+     */
+    [[nodiscard]] auto is_deadlock_signal_enabled() const noexcept -> bool;
+
     /**
      * Get the shape the observations should be viewed as.
      * @param compact True to use compact representation. 4 channels used for agent, wall, box, and goal. If agent/box
@@ -80,6 +178,25 @@ public:
      */
     [[nodiscard]] auto observation_shape(bool compact = true) const noexcept -> std::array<int, 3>;
 
+    /**
+     * Get the shape the observations in the given format should be viewed as.
+     * kFloat and kUint8 use the same shape as observation_shape(compact), kCellCode uses a single channel, and
+     * kBitPacked packs each channel plane into a row of ceil(rows * cols / 8) bytes, giving (C, 1, bytes).
+     * @param format Format of the observation
+     * @param compact True to use compact representation, ignored for kCellCode
+     * @return array indicating observation shape
+     */
+    [[nodiscard]] auto observation_shape(ObservationFormat format, bool compact = true) const noexcept
+        -> std::array<int, 3>;
+
+    /**
+     * Get the number of elements (floats for kFloat, bytes otherwise) in an observation of the given format.
+     * @param format Format of the observation
+     * @param compact True to use compact representation, ignored for kCellCode
+     * @return Product of observation_shape(format, compact)
+     */
+    [[nodiscard]] auto observation_size(ObservationFormat format, bool compact = true) const noexcept -> std::size_t;
+
     /**
      * Get a flat representation of the current state observation.
      * The observation should be viewed as the shape given by observation_shape().
@@ -88,17 +205,76 @@ public:
      */
     [[nodiscard]] auto get_observation(bool compact = true) const noexcept -> std::vector<float>;
 
+    /**
+     * Write the flat representation of the current state observation into a caller provided buffer, without
+     * allocating. The buffer is fully overwritten, and should be viewed as the shape given by observation_shape().
+     * @param out Contiguous buffer with room for the product of observation_shape(compact)
+     * @param compact True to use compact representation
+     */
+    void write_observation(float* out, bool compact = true) const noexcept;
+
+    /**
+     * Get a flat byte representation of the current state observation, for any format other than kFloat.
+     * The observation should be viewed as the shape given by observation_shape(format, compact).
+     * @param format Format of the observation
+     * @param compact True to use compact representation, ignored for kCellCode
+     * @return byte vector of the observation
+     */
+    [[nodiscard]] auto get_observation_bytes(ObservationFormat format, bool compact = true) const
+        -> std::vector<uint8_t>;
+
+    /**
+     * Write a byte representation of the current state observation into a caller provided buffer, without
+     * allocating. The buffer is fully overwritten.
+     * @param out Contiguous buffer with room for observation_size(format, compact) bytes
+     * @param format Format of the observation, any format other than kFloat
+     * @param compact True to use compact representation, ignored for kCellCode
+     */
+    void write_observation(uint8_t* out, ObservationFormat format, bool compact = true) const;
+
+    /**
+     * Rewrite the channels of a single cell in an observation buffer, leaving every other cell untouched.
+     * Produces the same values for that cell as write_observation().
+     * @param out Buffer previously filled by write_observation() with the same compact setting
+     * @param index Flat index of the cell to rewrite
+     * @param compact True to use compact representation
+     */
+    void write_observation_cell(float* out, int index, bool compact = true) const noexcept;
+
     /**
      * Get the shape the image should be viewed as.
+     * @param tile_size Pixels per side of each board tile
+     * @param grayscale True for a single luma channel, RGB otherwise
      * @return array indicating observation HWC
      */
-    [[nodiscard]] auto image_shape() const noexcept -> std::array<int, 3>;
+    [[nodiscard]] auto image_shape(TileSize tile_size = TileSize::k32, bool grayscale = false) const noexcept
+        -> std::array<int, 3>;
 
     /**
      * Get the flat (HWC) image representation of the current state
-     * @return flattened byte vector represending RGB values (HWC)
+     * @param tile_size Pixels per side of each board tile
+     * @param grayscale True for a single luma channel, RGB otherwise
+     * @return flattened byte vector represending RGB (or luma) values (HWC)
+     */
+    [[nodiscard]] auto to_image(TileSize tile_size = TileSize::k32, bool grayscale = false) const
+        -> std::vector<uint8_t>;
+
+    /**
+     * Write the flat (HWC) image representation of the current state into a caller provided buffer.
+     * @param out Contiguous buffer with room for the product of image_shape(tile_size, grayscale) bytes
+     * @param tile_size Pixels per side of each board tile
+     * @param grayscale True for a single luma channel, RGB otherwise
+     */
+    void write_image(uint8_t* out, TileSize tile_size = TileSize::k32, bool grayscale = false) const;
+
+    /**
+     * Redraw the tile of a single cell in an image buffer, leaving every other tile untouched.
+     * @param out Buffer holding an image of a state of the same level, see write_image()
+     * @param index Flat index of the cell to redraw
+     * @param tile_size Pixels per side of each board tile, same as the image was written with
+     * @param grayscale True for a single luma channel, same as the image was written with
      */
-    [[nodiscard]] auto to_image() const noexcept -> std::vector<uint8_t>;
+    void write_image_tile(uint8_t* out, int index, TileSize tile_size = TileSize::k32, bool grayscale = false) const;
 
     /**
      * Get the current reward signal as a result of the previous action taken.
@@ -142,43 +318,70 @@ public:
      */
     [[nodiscard]] auto get_agent_index() const noexcept -> int;
 
+    /**
+     * Get the bitboard of all boxes
+     * @return Bitboard with box cells set
+     */
+    [[nodiscard]] auto get_box_bitboard() const noexcept -> const BoardBitboard&;
+
+    /**
+     * Get the immutable level data shared by all states of this level.
+     * @return Shared level
+     */
+    [[nodiscard]] auto get_level() const noexcept -> const std::shared_ptr<const Level>&;
+
     friend std::ostream& operator<<(std::ostream& os, const SokobanGameState& state);
+    friend class StatePool;
+    friend void write_action_masks(std::span<const SokobanGameState> states, uint8_t* legal, uint8_t* push) noexcept;
 
     [[nodiscard]] auto pack() const -> InternalState {
         std::vector<int> _board_static;
-        _board_static.reserve(board_static.size());
-        for (const auto& el : board_static) {
+        _board_static.reserve(level->get_board_static().size());
+        for (const auto& el : level->get_board_static()) {
             _board_static.push_back(static_cast<int>(el));
         }
-        return {.rows = rows,
-                .cols = cols,
+        std::vector<bool> _is_box(static_cast<std::size_t>(level->get_flat_size()), false);
+        boxes.for_each([&](int i) { _is_box[static_cast<std::size_t>(i)] = true; });
+        return {.rows = level->get_rows(),
+                .cols = level->get_cols(),
                 .agent_idx = agent_idx,
                 .hash = zorb_hash,
                 .reward_signal = reward_signal,
                 .board_static = _board_static,
-                .is_box = is_box};
+                .is_box = _is_box,
+                .deadlock_signal = deadlock_signal,
+                .level = level};
     }
 
 private:
-    void _get_observation_non_compact(std::vector<float>& obs) const noexcept;
-    void _get_observation_compact(std::vector<float>& obs) const noexcept;
-    [[nodiscard]] int IndexFromAction(int index, Action action) const noexcept;
-    [[nodiscard]] bool InBounds(int index, Action action) const noexcept;
-    [[nodiscard]] bool IsTraversible(int index, Action action) const noexcept;
-    [[nodiscard]] bool IsPushable(int index, Action action) const noexcept;
-    void MoveAgent(Action action) noexcept;
-    void MoveBox(int box_index, Action action) noexcept;
-    void Push(int index, Action action) noexcept;
-
-    int rows = -1;
-    int cols = -1;
+    template <typename T>
+    void _get_observation_non_compact(T* obs) const noexcept;
+    template <typename T>
+    void _get_observation_compact(T* obs) const noexcept;
+    void _get_observation_cell_code(uint8_t* obs) const noexcept;
+    void _get_observation_bit_packed(uint8_t* obs, bool compact) const noexcept;
+    void Init(int rows, int cols, std::span<const uint8_t> codes);
+    void MoveAgent(int new_index) noexcept;
+    void MoveBox(int box_index, int box_new_index) noexcept;
+    [[nodiscard]] auto ActionMasks() const noexcept -> std::pair<uint8_t, uint8_t>;
+    [[nodiscard]] auto FreezeCheck(int box_index, BoardBitboard& blocking) const noexcept -> std::pair<bool, bool>;
+
+    std::shared_ptr<const Level> level;
     int agent_idx = -1;
     uint64_t zorb_hash = 0;
     uint64_t reward_signal = 0;
-    std::vector<Element> board_static;
-    std::vector<bool> is_box;
+    bool deadlock_signal = false;
+    BoardBitboard boxes;
 };
 
+/**
+ * Write the action masks of many states, see SokobanGameState::legal_action_mask() and push_action_mask().
+ * @param states States to write the masks of
+ * @param legal Output buffer of states.size() legal action masks
+ * @param push Output buffer of states.size() push action masks, or nullptr to skip
+ */
+void write_action_masks(std::span<const SokobanGameState> states, uint8_t* legal, uint8_t* push = nullptr) noexcept;
+
 }    // namespace sokoban
 
 template <>
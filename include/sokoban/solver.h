@@ -0,0 +1,79 @@
+#ifndef SOKOBAN_SOLVER_H_
+#define SOKOBAN_SOLVER_H_
+
+#include <sokoban/definitions.h>
+#include <sokoban/heuristics.h>
+#include <sokoban/sokoban_base.h>
+#include <sokoban/transposition_table.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sokoban {
+
+enum class SearchAlgorithm {
+    kAStar = 0,
+    kIDAStar = 1,
+    kHDAStar = 2,    // Parallel A* with states distributed to owner threads by hash
+};
+
+enum class SolverStatus {
+    kSolved = 0,          // Solution found
+    kUnsolvable = 1,      // Search space exhausted without finding a solution
+    kLimitReached = 2,    // Node or memory limit hit before a solution was found
+};
+
+struct SolverOptions {
+    SearchAlgorithm algorithm = SearchAlgorithm::kAStar;
+    // Heuristic to guide the search, if empty the matching heuristic updated incrementally from the parent state
+    Heuristic heuristic;
+    // Maximum number of node expansions, 0 for no limit
+    uint64_t max_expansions = 0;
+    // Approximate maximum number of bytes used by the open and closed lists, 0 for no limit
+    std::size_t max_memory_bytes = 0;
+    // Drop successors whose pushed box is deadlocked, see SokobanGameState::is_box_deadlocked()
+    bool prune_deadlocks = true;
+    // Table for duplicate detection (A* and HDA*), shared by all threads of the search. It is cleared when the search
+    // starts, so it can be reused by later searches to avoid reallocating, but not used by two searches at once. If
+    // null the search uses its own table (one per thread for HDA*), grown as needed within max_memory_bytes.
+    TranspositionTable* transposition_table = nullptr;
+    // Number of threads (HDA* only), 0 for one per hardware thread
+    int num_threads = 0;
+};
+
+struct SolverStats {
+    uint64_t expanded = 0;              // Nodes whose successors were generated
+    uint64_t generated = 0;             // Successor nodes generated
+    uint64_t duplicates = 0;            // Successors dropped as already seen with a lower or equal cost
+    uint64_t pruned = 0;                // Successors dropped as deadlocked or reported unsolvable by the heuristic
+    uint64_t iterations = 0;            // Cost threshold iterations (IDA* only)
+    uint64_t messages = 0;              // Successors sent to another thread (HDA* only)
+    std::size_t peak_memory_bytes = 0;  // Approximate peak size of the open and closed lists
+    double elapsed_seconds = 0;
+};
+
+struct SolverResult {
+    SolverStatus status = SolverStatus::kUnsolvable;
+    // Full action sequence (walking and pushing) solving the state, empty if not solved
+    std::vector<Action> actions;
+    // Number of pushes in the solution, -1 if not solved
+    int num_pushes = -1;
+    SolverStats stats;
+};
+
+/**
+ * Search for a solution of the given state.
+ * The search runs over push moves from PushGenerator: each successor pushes a box once, after walking to it along a
+ * shortest path. States are identified by PushGenerator::canonical_key(), so states differing only by the agent's
+ * position within its reachable region are searched once. With an admissible heuristic the solution uses the fewest
+ * pushes.
+ * @param state State to solve
+ * @param options Search algorithm, heuristic, and limits
+ * @return Status, solution actions, and search statistics
+ */
+[[nodiscard]] auto solve(const SokobanGameState& state, const SolverOptions& options = {}) -> SolverResult;
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_SOLVER_H_
@@ -0,0 +1,138 @@
+#ifndef SOKOBAN_STATE_POOL_H_
+#define SOKOBAN_STATE_POOL_H_
+
+#include <sokoban/sokoban_base.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace sokoban {
+
+// Index of a state in a StatePool, valid until the pool is cleared
+using StateHandle = uint32_t;
+
+// Compact store for many states of one level, such as a search frontier.
+// States are kept as fixed size records split by field: agent cells, hashes and reward signals in their own arrays,
+// and boxes as bitsets of only as many words as the level needs. Records live in slabs of a fixed number of states,
+// which are allocated as the pool grows within its memory budget and kept by clear(), so refilling a pool doesn't
+// allocate. Everything a state shares with its level, such as the deadlock signal setting, comes from the prototype.
+class StatePool {
+public:
+    static constexpr std::size_t kDefaultStatesPerSlab = std::size_t{1} << 16;
+
+    /**
+     * @param prototype Any state of the level to store, states are rebuilt on top of a copy of it
+     * @param max_memory_bytes Budget for the slabs, 0 for no limit
+     * @param states_per_slab Number of states per slab, rounded up to a power of two
+     * @throws std::invalid_argument if the budget doesn't fit a single slab
+     */
+    explicit StatePool(const SokobanGameState& prototype, std::size_t max_memory_bytes = 0,
+                       std::size_t states_per_slab = kDefaultStatesPerSlab);
+
+    /**
+     * Add a state.
+     * @param state State of the pool's level
+     * @return Handle of the stored state, or empty if the memory budget is used up
+     * @throws std::invalid_argument if the state is of another level
+     */
+    [[nodiscard]] auto push(const SokobanGameState& state) -> std::optional<StateHandle>;
+
+    /**
+     * Overwrite a state with a stored one, without allocating or touching the shared level.
+     * @param handle Handle returned by push()
+     * @param out State of the pool's level to overwrite
+     * @throws std::invalid_argument if out is of another level
+     * @throws std::out_of_range if the handle is not in the pool
+     */
+    void load(StateHandle handle, SokobanGameState& out) const;
+
+    /**
+     * Get a copy of a stored state.
+     * @param handle Handle returned by push()
+     * @return Stored state
+     * @throws std::out_of_range if the handle is not in the pool
+     */
+    [[nodiscard]] auto get(StateHandle handle) const -> SokobanGameState;
+
+    /**
+     * Get the agent cell of a stored state.
+     * @param handle Handle returned by push()
+     * @return Flat index of the agent
+     */
+    [[nodiscard]] auto get_agent_index(StateHandle handle) const noexcept -> int;
+
+    /**
+     * Get the hash of a stored state, see SokobanGameState::get_hash().
+     * @param handle Handle returned by push()
+     * @return Hash value
+     */
+    [[nodiscard]] auto get_hash(StateHandle handle) const noexcept -> uint64_t;
+
+    /**
+     * Check if a stored state is solved, without rebuilding it.
+     * @param handle Handle returned by push()
+     * @return True if every goal holds a box
+     */
+    [[nodiscard]] auto is_solution(StateHandle handle) const noexcept -> bool;
+
+    /**
+     * Remove all states, keeping the slabs for reuse.
+     */
+    void clear() noexcept;
+
+    /**
+     * Get the number of stored states.
+     * @return Number of states
+     */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /**
+     * Get the number of states the allocated slabs hold.
+     * @return Capacity
+     */
+    [[nodiscard]] auto get_capacity() const noexcept -> std::size_t;
+
+    /**
+     * Get the memory used by the allocated slabs.
+     * @return Bytes
+     */
+    [[nodiscard]] auto get_memory_bytes() const noexcept -> std::size_t;
+
+    /**
+     * Get the bytes one stored state takes.
+     * @return Bytes per state
+     */
+    [[nodiscard]] auto get_record_bytes() const noexcept -> std::size_t;
+
+    /**
+     * Get the level of the stored states.
+     * @return Shared level
+     */
+    [[nodiscard]] auto get_level() const noexcept -> const std::shared_ptr<const Level>&;
+
+private:
+    struct Slab {
+        std::vector<uint16_t> agents;
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> reward_signals;
+        std::vector<uint64_t> boxes;    // box_words per state
+    };
+
+    [[nodiscard]] auto SameLevel(const SokobanGameState& state) const noexcept -> bool;
+    [[nodiscard]] auto Boxes(StateHandle handle) const noexcept -> const uint64_t*;
+
+    SokobanGameState prototype;
+    std::size_t box_words;
+    std::size_t slab_shift;
+    std::size_t slab_mask;
+    std::size_t max_slabs;
+    std::vector<Slab> slabs;
+    std::size_t num_states = 0;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_STATE_POOL_H_
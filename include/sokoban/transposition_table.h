@@ -0,0 +1,136 @@
+#ifndef SOKOBAN_TRANSPOSITION_TABLE_H_
+#define SOKOBAN_TRANSPOSITION_TABLE_H_
+
+#include <sokoban/push_generator.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sokoban {
+
+// Which entry gives way when a new key finds no free entry within its probe window
+enum class ReplacementPolicy {
+    kKeepExisting = 0,          // Drop the new entry
+    kReplaceHighestCost = 1,    // Replace the entry with the highest cost if it is higher than the new entry's
+    kAlwaysReplace = 2,         // Replace the entry at the key's home position
+};
+
+enum class InsertResult {
+    kInserted = 0,     // Key was not present and took a free entry
+    kImproved = 1,     // Key was present with a higher cost, which was lowered
+    kDuplicate = 2,    // Key was present with a lower or equal cost, nothing changed
+    kReplaced = 3,     // Key was not present and replaced another key's entry
+    kDropped = 4,      // Key was not present and no entry could be used, nothing changed
+};
+
+// Search node as stored in the table, the push leads from the parent to the state of the key.
+// Entries hold no packed state, as searches keep the states of their open nodes and build solutions from those, so the
+// table only filters duplicates by cost. A node can still be rebuilt by following parent keys back to the start and
+// replaying the pushes, as long as none of those entries was replaced. Keys are trusted as is, so two states whose
+// 64 bit keys collide are taken for one and the collision goes undetected.
+struct TranspositionEntry {
+    uint64_t key = 0;
+    int g = 0;    // Cost from the start, must not be negative
+    uint64_t parent_key = 0;
+    PushMove push{};
+};
+
+// Fixed capacity open addressing hash table for search nodes, keyed by state hashes such as
+// PushGenerator::canonical_key(). Safe for concurrent find() and insert() from any number of threads.
+// Each entry carries a sequence number. Readers take a consistent snapshot by checking the sequence number didn't
+// change while reading, and only retry while a write to the same entry is in flight. Writers claim an entry with a
+// compare and swap on the sequence number of the snapshot they decided on, so a concurrent change to the entry makes
+// the writer re-read instead of overwrite. No locks are held across entries.
+// Keys are probed linearly within a short window, when the window is full the replacement policy decides.
+class TranspositionTable {
+public:
+    /**
+     * @param max_memory_bytes Memory cap, the capacity is the largest power of two number of entries which fits
+     * @param policy Replacement policy when a key's probe window is full
+     * @throws std::invalid_argument if the cap doesn't fit a minimum number of entries
+     */
+    explicit TranspositionTable(std::size_t max_memory_bytes,
+                                ReplacementPolicy policy = ReplacementPolicy::kReplaceHighestCost);
+
+    /**
+     * Insert a key, or lower its cost if it is already present with a higher one.
+     * @param entry Key, cost, and how it was reached
+     * @return What was done, see InsertResult
+     */
+    auto insert(const TranspositionEntry& entry) noexcept -> InsertResult;
+
+    /**
+     * Find a key.
+     * @param key Key to find
+     * @return Entry of the key, or empty if not present or replaced
+     */
+    [[nodiscard]] auto find(uint64_t key) const noexcept -> std::optional<TranspositionEntry>;
+
+    /**
+     * Remove all entries. Not safe to call while other threads use the table.
+     */
+    void clear() noexcept;
+
+    /**
+     * Rebuild the table with a new memory cap, keeping as many entries as fit. Not safe to call while other threads
+     * use the table.
+     * @param max_memory_bytes New memory cap, see the constructor
+     * @throws std::invalid_argument if the cap doesn't fit a minimum number of entries
+     */
+    void rehash(std::size_t max_memory_bytes);
+
+    /**
+     * Get the number of entries the table can hold.
+     * @return Capacity
+     */
+    [[nodiscard]] auto get_capacity() const noexcept -> std::size_t;
+
+    /**
+     * Get the number of used entries, approximate while other threads insert.
+     * @return Number of entries
+     */
+    [[nodiscard]] auto get_size() const noexcept -> std::size_t;
+
+    /**
+     * Get the memory used by the entries.
+     * @return Bytes
+     */
+    [[nodiscard]] auto get_memory_bytes() const noexcept -> std::size_t;
+
+    /**
+     * Get the replacement policy.
+     * @return Policy
+     */
+    [[nodiscard]] auto get_policy() const noexcept -> ReplacementPolicy;
+
+private:
+    // One cache line holds two slots, costs of empty slots are negative
+    struct alignas(32) Slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<int32_t> g{-1};
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> parent_key{0};
+        std::atomic<uint64_t> push{0};
+    };
+
+    struct Snapshot {
+        uint32_t sequence;
+        TranspositionEntry entry;
+    };
+
+    [[nodiscard]] static auto Read(const Slot& slot) noexcept -> Snapshot;
+    static auto TryWrite(Slot& slot, uint32_t sequence, const TranspositionEntry& entry) noexcept -> bool;
+    [[nodiscard]] static auto CapacityFor(std::size_t max_memory_bytes) -> std::size_t;
+
+    ReplacementPolicy policy;
+    std::vector<Slot> slots;
+    std::size_t mask = 0;
+    std::atomic<std::size_t> size{0};
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_TRANSPOSITION_TABLE_H_
@@ -0,0 +1,117 @@
+#ifndef SOKOBAN_VEC_ENV_H_
+#define SOKOBAN_VEC_ENV_H_
+
+#include <sokoban/definitions.h>
+#include <sokoban/sokoban_base.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sokoban {
+
+class ThreadPool;
+
+// Batch of N game states stepped together, which auto-reset from a pool of levels once solved.
+// All levels in the pool must share the same dimensions so observations can be written into one contiguous buffer.
+// Environments can be split across worker threads, results do not depend on the number of threads.
+class SokobanVecEnv {
+public:
+    SokobanVecEnv() = delete;
+    /**
+     * @param level_pool Initial states to sample from when an environment resets
+     * @param num_envs Number of environments to step in parallel
+     * @param seed Seed for sampling levels from the pool
+     * @param compact True to use compact observations, see SokobanGameState::observation_shape
+     * @param num_threads Number of threads to split stepping and observation generation between
+     */
+    SokobanVecEnv(std::vector<SokobanGameState> level_pool, int num_envs, uint64_t seed = 0, bool compact = false,
+                  int num_threads = 1);
+    ~SokobanVecEnv();
+
+    SokobanVecEnv(const SokobanVecEnv&) = delete;
+    SokobanVecEnv(SokobanVecEnv&&) noexcept;
+    auto operator=(const SokobanVecEnv&) -> SokobanVecEnv& = delete;
+    auto operator=(SokobanVecEnv&&) noexcept -> SokobanVecEnv&;
+
+    /**
+     * Get the number of environments.
+     * @return Count of environments
+     */
+    [[nodiscard]] auto num_envs() const noexcept -> int;
+
+    /**
+     * Get the number of threads environments are split between.
+     * @return Thread count
+     */
+    [[nodiscard]] auto num_threads() const noexcept -> int;
+
+    /**
+     * Get the shape a single environment observation should be viewed as.
+     * @return array indicating observation CHW
+     */
+    [[nodiscard]] auto observation_shape() const noexcept -> std::array<int, 3>;
+
+    /**
+     * Get the number of floats in a single environment observation.
+     * @return Flat observation size
+     */
+    [[nodiscard]] auto observation_size() const noexcept -> std::size_t;
+
+    /**
+     * Reset every environment to a level sampled from the pool.
+     * @param observations Output buffer of size num_envs * observation_size(), or nullptr to skip
+     */
+    void reset(float* observations);
+
+    /**
+     * Apply one action to every environment, environments which become solved are reset from the pool.
+     * The observation written for a reset environment is the one of the new level.
+     * @param actions Buffer of num_envs actions
+     * @param reward_signals Output buffer of num_envs reward signals, see SokobanGameState::get_reward_signal
+     * @param solved Output buffer of num_envs flags, 1 if the action solved the level
+     * @param observations Output buffer of size num_envs * observation_size(), or nullptr to skip
+     */
+    void step(const int32_t* actions, uint64_t* reward_signals, uint8_t* solved, float* observations);
+
+    /**
+     * Write the observations of the current states of all environments.
+     * @param observations Output buffer of size num_envs * observation_size()
+     */
+    void observe(float* observations) const;
+
+    /**
+     * Write the action masks of the current states of all environments, see SokobanGameState::legal_action_mask().
+     * @param legal Output buffer of num_envs legal action masks
+     * @param push Output buffer of num_envs push action masks, or nullptr to skip
+     */
+    void action_masks(uint8_t* legal, uint8_t* push) const;
+
+    /**
+     * Get the current state of an environment.
+     * @param index Index of the environment
+     * @return State of the environment
+     */
+    [[nodiscard]] auto get_state(int index) const -> const SokobanGameState&;
+
+    /**
+     * Get the current states of all environments.
+     * @return States of the environments
+     */
+    [[nodiscard]] auto get_states() const noexcept -> const std::vector<SokobanGameState>&;
+
+private:
+    void ResetEnv(std::size_t index);
+    void WriteObservation(std::size_t index, float* observations) const;
+
+    std::vector<SokobanGameState> level_pool;
+    std::vector<SokobanGameState> states;
+    std::vector<uint64_t> rng_states;
+    bool compact;
+    std::unique_ptr<ThreadPool> thread_pool;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_VEC_ENV_H_
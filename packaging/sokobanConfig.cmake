@@ -21,6 +21,9 @@ if (sokoban_comp_static AND sokoban_comp_shared)
     return()
 endif ()
 
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
 set(sokoban_static_targets "${CMAKE_CURRENT_LIST_DIR}/sokoban-static-targets.cmake")
 set(sokoban_shared_targets "${CMAKE_CURRENT_LIST_DIR}/sokoban-shared-targets.cmake")
 
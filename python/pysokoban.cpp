@@ -1,6 +1,12 @@
 // pysokoban.cpp
 // Python bindings
 
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+
 #include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
@@ -10,9 +16,114 @@
 
 namespace py = pybind11;
 
+namespace {
+auto to_bytes(const std::vector<uint8_t> &data) -> py::bytes {
+    return {reinterpret_cast<const char *>(data.data()), data.size()};    // NOLINT(*-reinterpret-cast)
+}
+
+// View of the buffer of a bytes object, valid while the object is alive
+auto to_span(const py::bytes &data) -> std::span<const uint8_t> {
+    const std::string_view view(data);
+    return {reinterpret_cast<const uint8_t *>(view.data()), view.size()};    // NOLINT(*-reinterpret-cast)
+}
+
+// Copy a flat observation into a strided 3D view
+template <typename E>
+void copy_strided(const std::vector<E> &obs, py::array &out) {
+    auto view = out.mutable_unchecked<E, 3>();
+    std::size_t i = 0;
+    for (py::ssize_t c = 0; c < view.shape(0); ++c) {
+        for (py::ssize_t h = 0; h < view.shape(1); ++h) {
+            for (py::ssize_t w = 0; w < view.shape(2); ++w) {
+                view(c, h, w) = obs[i++];
+            }
+        }
+    }
+}
+
+// Write an observation into a preallocated array, which can be a strided view into a larger batch.
+// kFloat expects a float32 array, all other formats a uint8 array
+void write_observation_into(const sokoban::SokobanGameState &state, py::array &out,
+                            sokoban::ObservationFormat format, bool compact) {
+    const bool is_float = format == sokoban::ObservationFormat::kFloat;
+    const auto obs_shape = state.observation_shape(format, compact);
+    if (is_float && !out.dtype().is(py::dtype::of<float>())) {
+        throw std::invalid_argument("Expected out to be a float32 array.");
+    }
+    if (!is_float && !out.dtype().is(py::dtype::of<uint8_t>())) {
+        throw std::invalid_argument("Expected out to be a uint8 array.");
+    }
+    if (!out.writeable()) {
+        throw std::invalid_argument("Expected out to be writeable.");
+    }
+    if (out.ndim() != 3 || out.shape(0) != obs_shape[0] || out.shape(1) != obs_shape[1] ||
+        out.shape(2) != obs_shape[2]) {
+        throw std::invalid_argument("Expected out to have shape observation_shape(format, compact).");
+    }
+    if ((out.flags() & py::array::c_style) != 0) {
+        if (is_float) {
+            state.write_observation(static_cast<float *>(out.mutable_data()), compact);
+        } else {
+            state.write_observation(static_cast<uint8_t *>(out.mutable_data()), format, compact);
+        }
+        return;
+    }
+    // Strided view, go through a scratch buffer which is reused between calls
+    const auto obs_size = state.observation_size(format, compact);
+    if (is_float) {
+        thread_local std::vector<float> scratch;
+        scratch.resize(obs_size);
+        state.write_observation(scratch.data(), compact);
+        copy_strided(scratch, out);
+    } else {
+        thread_local std::vector<uint8_t> scratch;
+        scratch.resize(obs_size);
+        state.write_observation(scratch.data(), format, compact);
+        copy_strided(scratch, out);
+    }
+}
+
+// Tile sizes are passed as pixels from python
+auto to_tile_size(int tile_size) -> sokoban::TileSize {
+    switch (tile_size) {
+        case static_cast<int>(sokoban::TileSize::k1):
+        case static_cast<int>(sokoban::TileSize::k8):
+        case static_cast<int>(sokoban::TileSize::k16):
+        case static_cast<int>(sokoban::TileSize::k32):
+            return static_cast<sokoban::TileSize>(tile_size);
+        default:
+            throw std::invalid_argument("Expected tile_size to be one of 1, 8, 16 or 32.");
+    }
+}
+
+// Shape of a batch of observations (NCHW)
+auto batch_observation_shape(const sokoban::SokobanVecEnv &env) -> std::array<py::ssize_t, 4> {
+    const auto obs_shape = env.observation_shape();
+    return {env.num_envs(), obs_shape[0], obs_shape[1], obs_shape[2]};
+}
+}    // namespace
+
 PYBIND11_MODULE(pysokoban, m) {
     m.doc() = "Sokoban environment module docs.";
     using T = sokoban::SokobanGameState;
+    using sokoban::ObservationFormat;
+
+    py::enum_<ObservationFormat>(m, "ObservationFormat")
+        .value("FLOAT", ObservationFormat::kFloat)
+        .value("UINT8", ObservationFormat::kUint8)
+        .value("CELL_CODE", ObservationFormat::kCellCode)
+        .value("BIT_PACKED", ObservationFormat::kBitPacked);
+
+    m.attr("REWARD_BOX_IN_GOAL") = static_cast<uint64_t>(sokoban::kRewardBoxInGoal);
+    m.attr("REWARD_ALL_BOXES_IN_GOAL") = static_cast<uint64_t>(sokoban::kRewardAllBoxesInGoal);
+    m.attr("REWARD_DEADLOCK") = static_cast<uint64_t>(sokoban::kRewardDeadlock);
+
+    using sokoban::UndoRecord;
+    py::class_<UndoRecord>(m, "UndoRecord")
+        .def_readonly("agent_index", &UndoRecord::agent_index)
+        .def_readonly("box_from", &UndoRecord::box_from)
+        .def_readonly("box_to", &UndoRecord::box_to)
+        .def_readonly("reward_signal", &UndoRecord::reward_signal);
 
     py::class_<T>(m, "SokobanGameState")
         .def(py::init<const std::string &>())
@@ -31,11 +142,15 @@ PYBIND11_MODULE(pysokoban, m) {
              })
         .def(py::pickle(
             [](const T &self) {    // __getstate__
-                auto s = self.pack();
-                return py::make_tuple(s.rows, s.cols, s.agent_idx, s.hash, s.reward_signal, s.board_static, s.is_box);
+                return to_bytes(sokoban::serialize(self));
             },
-            [](py::tuple t) -> T {    // __setstate__
-                if (t.size() != 7) {
+            [](const py::object &state) -> T {    // __setstate__
+                if (py::isinstance<py::bytes>(state)) {
+                    return sokoban::deserialize(to_span(state.cast<py::bytes>()));
+                }
+                // Tuples are from before the binary format, 7 elements from before the deadlock signal was added
+                const auto t = state.cast<py::tuple>();
+                if (t.size() != 7 && t.size() != 8) {
                     throw std::runtime_error("Invalid state");
                 }
                 T::InternalState s;
@@ -46,8 +161,15 @@ PYBIND11_MODULE(pysokoban, m) {
                 s.reward_signal = t[4].cast<uint64_t>();           // NOLINT(*-magic-numbers)
                 s.board_static = t[5].cast<std::vector<int>>();    // NOLINT(*-magic-numbers)
                 s.is_box = t[6].cast<std::vector<bool>>();         // NOLINT(*-magic-numbers)
+                if (t.size() > 7) {                           // NOLINT(*-magic-numbers)
+                    s.deadlock_signal = t[7].cast<bool>();    // NOLINT(*-magic-numbers)
+                }
                 return {std::move(s)};
             }))
+        .def("serialize", [](const T &self) { return to_bytes(sokoban::serialize(self)); })
+        .def_static(
+            "deserialize", [](const py::bytes &data) -> T { return sokoban::deserialize(to_span(data)); },
+            py::arg("data"))
         .def("apply_action",
              [](T &self, int action) {
                  if (action < 0 || action >= T::action_space_size()) {
@@ -55,28 +177,593 @@ PYBIND11_MODULE(pysokoban, m) {
                  }
                  self.apply_action(static_cast<sokoban::Action>(action));
              })
+        .def("apply_push",
+             [](T &self, int agent_cell, int action) {
+                 if (action < 0 || action >= T::action_space_size()) {
+                     throw std::invalid_argument("Invalid action.");
+                 }
+                 if (agent_cell < 0 || agent_cell >= self.get_level()->get_flat_size() ||
+                     self.get_level()->is_wall(agent_cell)) {
+                     throw std::invalid_argument("Invalid agent cell.");
+                 }
+                 self.apply_push(agent_cell, static_cast<sokoban::Action>(action));
+             })
+        .def("apply_action_undoable",
+             [](T &self, int action) {
+                 if (action < 0 || action >= T::action_space_size()) {
+                     throw std::invalid_argument("Invalid action.");
+                 }
+                 return self.apply_action_undoable(static_cast<sokoban::Action>(action));
+             })
+        .def("apply_push_undoable",
+             [](T &self, int agent_cell, int action) {
+                 if (action < 0 || action >= T::action_space_size()) {
+                     throw std::invalid_argument("Invalid action.");
+                 }
+                 if (agent_cell < 0 || agent_cell >= self.get_level()->get_flat_size() ||
+                     self.get_level()->is_wall(agent_cell)) {
+                     throw std::invalid_argument("Invalid agent cell.");
+                 }
+                 return self.apply_push_undoable(agent_cell, static_cast<sokoban::Action>(action));
+             })
+        .def("undo_action",
+             [](T &self, const UndoRecord &undo) {
+                 // Records of other states could put boxes or the agent on walls, reject what can't be undone
+                 const auto &level = *self.get_level();
+                 const auto free_cell = [&](int cell) {
+                     return cell >= 0 && cell < level.get_flat_size() && !level.is_wall(cell);
+                 };
+                 const auto &boxes = self.get_box_bitboard();
+                 const bool box_moved = undo.box_from != sokoban::kNoCell;
+                 const bool valid_box = !box_moved || (free_cell(undo.box_from) && free_cell(undo.box_to) &&
+                                                       boxes.test(undo.box_to) && !boxes.test(undo.box_from));
+                 // The agent must end on a cell without a box once the pushed box is moved back
+                 const bool agent_on_box = free_cell(undo.agent_index) && boxes.test(undo.agent_index) &&
+                                           !(box_moved && undo.agent_index == undo.box_to);
+                 const bool valid_agent = free_cell(undo.agent_index) && !agent_on_box &&
+                                          !(box_moved && undo.agent_index == undo.box_from);
+                 if (!valid_box || !valid_agent) {
+                     throw std::invalid_argument("Undo record doesn't match the state.");
+                 }
+                 self.undo_action(undo);
+             })
+        .def("legal_action_mask", &T::legal_action_mask)
+        .def("push_action_mask", &T::push_action_mask)
         .def("is_solution", &T::is_solution)
         .def("is_terminal", &T::is_solution)
-        .def("observation_shape", &T::observation_shape)
-        .def("observation_shape", [](const T &self) { return self.observation_shape(false); })
-        .def("get_observation",
+        .def("is_deadlocked", &T::is_deadlocked)
+        .def("is_box_deadlocked",
+             [](const T &self, int box_index) {
+                 if (box_index < 0 || box_index >= self.get_level()->get_flat_size() ||
+                     !self.get_box_bitboard().test(box_index)) {
+                     throw std::invalid_argument("Invalid box index.");
+                 }
+                 return self.is_box_deadlocked(box_index);
+             })
+        .def("set_deadlock_signal", &T::set_deadlock_signal, py::arg("enabled"))
+        .def("is_deadlock_signal_enabled", &T::is_deadlock_signal_enabled)
+        .def("get_push_distances",
+             [](const T &self) {
+                 // Goals in get_all_goal_indices() order by flat cell index, -1 where unreachable
+                 const auto &level = *self.get_level();
+                 const auto num_goals = static_cast<int>(level.get_goal_indices().size());
+                 py::array_t<int> distances({num_goals, level.get_flat_size()});
+                 auto view = distances.mutable_unchecked<2>();
+                 for (int goal = 0; goal < num_goals; ++goal) {
+                     for (int cell = 0; cell < level.get_flat_size(); ++cell) {
+                         const int distance = level.get_push_distance(goal, cell);
+                         view(goal, cell) = distance == sokoban::kUnreachable ? -1 : distance;
+                     }
+                 }
+                 return distances;
+             })
+        .def("get_dead_squares",
              [](const T &self) {
-                 py::array_t<float> out = py::cast(self.get_observation(false));
-                 return out.reshape(self.observation_shape(false));
-             })
-        .def("image_shape", &T::image_shape)
-        .def("to_image",
-             [](T &self) {
-                 py::array_t<uint8_t> out = py::cast(self.to_image());
-                 const auto obs_shape = self.observation_shape();
-                 return out.reshape({static_cast<py::ssize_t>(obs_shape[1] * sokoban::SPRITE_HEIGHT),
-                                     static_cast<py::ssize_t>(obs_shape[2] * sokoban::SPRITE_WIDTH),
-                                     static_cast<py::ssize_t>(sokoban::SPRITE_CHANNELS)});
+                 std::vector<int> indices;
+                 self.get_level()->get_dead_mask().for_each([&](int i) { indices.push_back(i); });
+                 return indices;
              })
+        .def("observation_shape", py::overload_cast<bool>(&T::observation_shape, py::const_))
+        .def("observation_shape", [](const T &self) { return self.observation_shape(false); })
+        .def("observation_shape", py::overload_cast<ObservationFormat, bool>(&T::observation_shape, py::const_),
+             py::arg("format"), py::arg("compact") = false)
+        .def(
+            "get_observation",
+            [](const T &self, bool compact, ObservationFormat format) -> py::array {
+                if (format == ObservationFormat::kFloat) {
+                    py::array_t<float> out(self.observation_shape(compact));
+                    self.write_observation(out.mutable_data(), compact);
+                    return out;
+                }
+                py::array_t<uint8_t> out(self.observation_shape(format, compact));
+                self.write_observation(out.mutable_data(), format, compact);
+                return out;
+            },
+            py::arg("compact") = false, py::arg("format") = ObservationFormat::kFloat)
+        .def(
+            "get_observation",
+            [](const T &self, py::array out, bool compact, ObservationFormat format) {
+                write_observation_into(self, out, format, compact);
+                return out;
+            },
+            py::arg("out"), py::arg("compact") = false, py::arg("format") = ObservationFormat::kFloat)
+        .def(
+            "image_shape",
+            [](const T &self, int tile_size, bool grayscale) {
+                return self.image_shape(to_tile_size(tile_size), grayscale);
+            },
+            py::arg("tile_size") = sokoban::SPRITE_WIDTH, py::arg("grayscale") = false)
+        .def(
+            "to_image",
+            [](const T &self, int tile_size, bool grayscale) {
+                py::array_t<uint8_t> out(self.image_shape(to_tile_size(tile_size), grayscale));
+                self.write_image(out.mutable_data(), to_tile_size(tile_size), grayscale);
+                return out;
+            },
+            py::arg("tile_size") = sokoban::SPRITE_WIDTH, py::arg("grayscale") = false)
         .def("get_reward_signal", &T::get_reward_signal)
         .def("get_agent_index", &T::get_agent_index)
         .def("get_box_indices", &T::get_box_indices)
         .def("get_empty_goal_indices", &T::get_empty_goal_indices)
         .def("get_solved_goal_indices", &T::get_solved_goal_indices)
         .def("get_all_goal_indices", &T::get_all_goal_indices);
+
+    using sokoban::Renderer;
+    py::class_<Renderer>(m, "Renderer")
+        .def(py::init([](int tile_size, bool grayscale) { return Renderer(to_tile_size(tile_size), grayscale); }),
+             py::arg("tile_size") = sokoban::SPRITE_WIDTH, py::arg("grayscale") = false)
+        .def_property_readonly("tile_size", [](const Renderer &self) { return static_cast<int>(self.get_tile_size()); })
+        .def_property_readonly("grayscale", &Renderer::is_grayscale)
+        .def("render", [](Renderer &self, const T &state) {
+            const auto &img = self.render(state);
+            py::array_t<uint8_t> out(state.image_shape(self.get_tile_size(), self.is_grayscale()));
+            std::copy(img.begin(), img.end(), out.mutable_data());
+            return out;
+        });
+
+    using sokoban::LevelStore;
+    py::class_<LevelStore>(m, "LevelStore")
+        .def(py::init<>())
+        .def_static(
+            "from_file",
+            [](const std::string &path) {
+                const py::gil_scoped_release release;
+                return LevelStore::from_file(path);
+            },
+            py::arg("path"))
+        .def_static("from_string", &LevelStore::from_string, py::arg("text"))
+        .def("add", &LevelStore::add, py::arg("board_str"))
+        .def("__len__", &LevelStore::size)
+        .def("__getitem__", &LevelStore::get_state, py::arg("index"))
+        .def("get_rows", &LevelStore::get_rows, py::arg("index"))
+        .def("get_cols", &LevelStore::get_cols, py::arg("index"))
+        .def("get_states", &LevelStore::get_states)
+        .def_property_readonly("memory_bytes", &LevelStore::get_memory_bytes);
+
+    using sokoban::StateArchive;
+    py::class_<StateArchive>(m, "StateArchive")
+        .def(py::init<const std::string &>(), py::arg("path"))
+        .def_static(
+            "write",
+            [](const std::string &path, const std::vector<T> &states) {
+                const py::gil_scoped_release release;
+                StateArchive::write(path, states);
+            },
+            py::arg("path"), py::arg("states"))
+        .def("__len__", &StateArchive::size)
+        .def("__getitem__", &StateArchive::get_state, py::arg("index"));
+
+    using sokoban::StateHandle;
+    using sokoban::StatePool;
+    // Handles are checked here, the unchecked accessors trust them
+    const auto checked = [](const StatePool &pool, StateHandle handle) {
+        if (handle >= pool.size()) {
+            throw std::out_of_range("State handle out of range.");
+        }
+        return handle;
+    };
+    py::class_<StatePool>(m, "StatePool")
+        .def(py::init<const T &, std::size_t, std::size_t>(), py::arg("prototype"), py::arg("max_memory_bytes") = 0,
+             py::arg("states_per_slab") = StatePool::kDefaultStatesPerSlab)
+        .def("push", &StatePool::push, py::arg("state"))
+        .def("get", &StatePool::get, py::arg("handle"))
+        .def("load", &StatePool::load, py::arg("handle"), py::arg("out"))
+        .def(
+            "get_agent_index",
+            [checked](const StatePool &self, StateHandle handle) {
+                return self.get_agent_index(checked(self, handle));
+            },
+            py::arg("handle"))
+        .def(
+            "get_hash",
+            [checked](const StatePool &self, StateHandle handle) { return self.get_hash(checked(self, handle)); },
+            py::arg("handle"))
+        .def(
+            "is_solution",
+            [checked](const StatePool &self, StateHandle handle) { return self.is_solution(checked(self, handle)); },
+            py::arg("handle"))
+        .def("clear", &StatePool::clear)
+        .def("__len__", &StatePool::size)
+        .def_property_readonly("capacity", &StatePool::get_capacity)
+        .def_property_readonly("memory_bytes", &StatePool::get_memory_bytes)
+        .def_property_readonly("record_bytes", &StatePool::get_record_bytes);
+
+    // Batches travel as one (N, record size) uint8 array, which pickles as a single buffer
+    m.def(
+        "serialize_states",
+        [](const std::vector<T> &states) {
+            const auto record_size = states.empty() ? 0 : sokoban::serialized_size(states.front());
+            py::array_t<uint8_t> out({static_cast<py::ssize_t>(states.size()), static_cast<py::ssize_t>(record_size)});
+            {
+                const py::gil_scoped_release release;
+                sokoban::serialize_batch(states, out.mutable_data());
+            }
+            return out;
+        },
+        py::arg("states"));
+    m.def(
+        "deserialize_states",
+        [](const py::array_t<uint8_t, py::array::c_style | py::array::forcecast> &data) {
+            if (data.ndim() != 2) {
+                throw std::invalid_argument("Expected a 2D array of serialized states.");
+            }
+            const std::span<const uint8_t> bytes(data.data(), static_cast<std::size_t>(data.size()));
+            const auto record_size = static_cast<std::size_t>(data.shape(1));
+            const py::gil_scoped_release release;
+            return bytes.empty() ? std::vector<T>() : sokoban::deserialize_batch(bytes, record_size);
+        },
+        py::arg("data"));
+
+    // Bit a of each mask is set if action a changes the state (legal) or pushes a box (push)
+    m.def(
+        "action_masks",
+        [](const std::vector<T> &states) {
+            py::array_t<uint8_t> legal(static_cast<py::ssize_t>(states.size()));
+            py::array_t<uint8_t> push(static_cast<py::ssize_t>(states.size()));
+            uint8_t *legal_data = legal.mutable_data();
+            uint8_t *push_data = push.mutable_data();
+            {
+                const py::gil_scoped_release release;
+                sokoban::write_action_masks(states, legal_data, push_data);
+            }
+            return py::make_tuple(legal, push);
+        },
+        py::arg("states"));
+
+    using sokoban::PushGenerator;
+    py::class_<PushGenerator>(m, "PushGenerator")
+        .def(py::init<>())
+        // The generator shares the state's level for walks, so the state needn't be kept alive
+        .def("generate", &PushGenerator::generate)
+        .def("get_reachable",
+             [](const PushGenerator &self) {
+                 std::vector<int> cells;
+                 self.get_reachable().for_each([&](int cell) { cells.push_back(cell); });
+                 return cells;
+             })
+        .def("get_pushes",
+             [](const PushGenerator &self) {
+                 std::vector<std::tuple<int, int, int>> pushes;
+                 for (const auto &push : self.get_pushes()) {
+                     pushes.emplace_back(push.agent_cell, push.box_cell, static_cast<int>(push.direction));
+                 }
+                 return pushes;
+             })
+        .def("get_canonical_key", &PushGenerator::get_canonical_key)
+        .def("get_walk", [](PushGenerator &self, int target_cell) {
+            std::vector<sokoban::Action> actions;
+            self.append_walk(target_cell, actions);
+            std::vector<int> result;
+            result.reserve(actions.size());
+            for (const auto action : actions) {
+                result.push_back(static_cast<int>(action));
+            }
+            return result;
+        });
+
+    // Heuristics return None for unsolvable states, batched versions -1
+    const auto bind_heuristic = [&m](const char *name, int (*heuristic)(const T &)) {
+        m.def(name, [heuristic](const T &state) -> std::optional<int> {
+            const int cost = heuristic(state);
+            return cost == sokoban::kInfiniteCost ? std::nullopt : std::optional<int>(cost);
+        });
+        m.def(name, [heuristic](const std::vector<T> &states) {
+            py::array_t<int> costs(static_cast<py::ssize_t>(states.size()));
+            int *costs_data = costs.mutable_data();
+            const py::gil_scoped_release release;
+            for (std::size_t i = 0; i < states.size(); ++i) {
+                const int cost = heuristic(states[i]);
+                costs_data[i] = cost == sokoban::kInfiniteCost ? -1 : cost;
+            }
+            return costs;
+        });
+    };
+    bind_heuristic("manhattan_heuristic", &sokoban::manhattan_heuristic);
+    bind_heuristic("greedy_heuristic", &sokoban::greedy_heuristic);
+    bind_heuristic("matching_heuristic", &sokoban::matching_heuristic);
+
+    using sokoban::MatchingHeuristic;
+    const auto to_optional_cost = [](int cost) {
+        return cost == sokoban::kInfiniteCost ? std::nullopt : std::optional<int>(cost);
+    };
+    py::class_<MatchingHeuristic>(m, "MatchingHeuristic")
+        .def(py::init<>())
+        .def(
+            "reset",
+            [to_optional_cost](MatchingHeuristic &self, const T &state) { return to_optional_cost(self.reset(state)); },
+            py::keep_alive<1, 2>())
+        .def("evaluate_move",
+             [to_optional_cost](MatchingHeuristic &self, int box_cell, int box_new_cell) {
+                 return to_optional_cost(self.evaluate_move(box_cell, box_new_cell));
+             })
+        .def("move_box",
+             [to_optional_cost](MatchingHeuristic &self, int box_cell, int box_new_cell) {
+                 return to_optional_cost(self.move_box(box_cell, box_new_cell));
+             })
+        .def("get_cost",
+             [to_optional_cost](const MatchingHeuristic &self) { return to_optional_cost(self.get_cost()); });
+
+    py::enum_<sokoban::ReplacementPolicy>(m, "ReplacementPolicy")
+        .value("KEEP_EXISTING", sokoban::ReplacementPolicy::kKeepExisting)
+        .value("REPLACE_HIGHEST_COST", sokoban::ReplacementPolicy::kReplaceHighestCost)
+        .value("ALWAYS_REPLACE", sokoban::ReplacementPolicy::kAlwaysReplace);
+
+    py::enum_<sokoban::InsertResult>(m, "InsertResult")
+        .value("INSERTED", sokoban::InsertResult::kInserted)
+        .value("IMPROVED", sokoban::InsertResult::kImproved)
+        .value("DUPLICATE", sokoban::InsertResult::kDuplicate)
+        .value("REPLACED", sokoban::InsertResult::kReplaced)
+        .value("DROPPED", sokoban::InsertResult::kDropped);
+
+    // Entries are (g, parent_key, (agent_cell, box_cell, direction)) tuples
+    using sokoban::TranspositionTable;
+    py::class_<TranspositionTable>(m, "TranspositionTable")
+        .def(py::init<std::size_t, sokoban::ReplacementPolicy>(), py::arg("max_memory_bytes"),
+             py::arg("policy") = sokoban::ReplacementPolicy::kReplaceHighestCost)
+        .def(
+            "insert",
+            [](TranspositionTable &self, uint64_t key, int g, uint64_t parent_key,
+               const std::optional<std::tuple<int, int, int>> &push) {
+                if (g < 0) {
+                    throw std::invalid_argument("Cost must not be negative.");
+                }
+                sokoban::TranspositionEntry entry{.key = key, .g = g, .parent_key = parent_key};
+                if (push) {
+                    const auto [agent_cell, box_cell, direction] = *push;
+                    if (agent_cell < -1 || agent_cell >= sokoban::kMaxCells || box_cell < -1 ||
+                        box_cell >= sokoban::kMaxCells || direction < 0 || direction >= sokoban::kNumActions) {
+                        throw std::invalid_argument("Invalid push.");
+                    }
+                    entry.push = {agent_cell, box_cell, static_cast<sokoban::Action>(direction)};
+                }
+                return self.insert(entry);
+            },
+            py::arg("key"), py::arg("g"), py::arg("parent_key") = 0, py::arg("push") = py::none())
+        .def("find",
+             [](const TranspositionTable &self,
+                uint64_t key) -> std::optional<std::tuple<int, uint64_t, std::tuple<int, int, int>>> {
+                 const auto entry = self.find(key);
+                 if (!entry) {
+                     return std::nullopt;
+                 }
+                 return std::make_tuple(entry->g, entry->parent_key,
+                                        std::make_tuple(entry->push.agent_cell, entry->push.box_cell,
+                                                        static_cast<int>(entry->push.direction)));
+             })
+        .def("__contains__", [](const TranspositionTable &self, uint64_t key) { return self.find(key).has_value(); })
+        .def("__len__", &TranspositionTable::get_size)
+        .def("clear", &TranspositionTable::clear)
+        .def("rehash", &TranspositionTable::rehash, py::arg("max_memory_bytes"))
+        .def_property_readonly("capacity", &TranspositionTable::get_capacity)
+        .def_property_readonly("memory_bytes", &TranspositionTable::get_memory_bytes)
+        .def_property_readonly("policy", &TranspositionTable::get_policy);
+
+    py::enum_<sokoban::SearchAlgorithm>(m, "SearchAlgorithm")
+        .value("ASTAR", sokoban::SearchAlgorithm::kAStar)
+        .value("IDASTAR", sokoban::SearchAlgorithm::kIDAStar)
+        .value("HDASTAR", sokoban::SearchAlgorithm::kHDAStar);
+
+    py::enum_<sokoban::SolverStatus>(m, "SolverStatus")
+        .value("SOLVED", sokoban::SolverStatus::kSolved)
+        .value("UNSOLVABLE", sokoban::SolverStatus::kUnsolvable)
+        .value("LIMIT_REACHED", sokoban::SolverStatus::kLimitReached);
+
+    using sokoban::SolverStats;
+    py::class_<SolverStats>(m, "SolverStats")
+        .def_readonly("expanded", &SolverStats::expanded)
+        .def_readonly("generated", &SolverStats::generated)
+        .def_readonly("duplicates", &SolverStats::duplicates)
+        .def_readonly("pruned", &SolverStats::pruned)
+        .def_readonly("iterations", &SolverStats::iterations)
+        .def_readonly("messages", &SolverStats::messages)
+        .def_readonly("peak_memory_bytes", &SolverStats::peak_memory_bytes)
+        .def_readonly("elapsed_seconds", &SolverStats::elapsed_seconds);
+
+    using sokoban::SolverResult;
+    py::class_<SolverResult>(m, "SolverResult")
+        .def_readonly("status", &SolverResult::status)
+        .def_property_readonly("actions",
+                               [](const SolverResult &self) {
+                                   std::vector<int> actions;
+                                   actions.reserve(self.actions.size());
+                                   for (const auto action : self.actions) {
+                                       actions.push_back(static_cast<int>(action));
+                                   }
+                                   return actions;
+                               })
+        .def_readonly("num_pushes", &SolverResult::num_pushes)
+        .def_readonly("stats", &SolverResult::stats);
+
+    m.def(
+        "solve",
+        [](const T &state, sokoban::SearchAlgorithm algorithm, const std::optional<py::function> &heuristic,
+           uint64_t max_expansions, std::size_t max_memory_bytes, bool prune_deadlocks,
+           TranspositionTable *transposition_table, int num_threads) {
+            sokoban::SolverOptions options;
+            options.algorithm = algorithm;
+            options.max_expansions = max_expansions;
+            options.max_memory_bytes = max_memory_bytes;
+            options.prune_deadlocks = prune_deadlocks;
+            options.transposition_table = transposition_table;
+            options.num_threads = num_threads;
+            if (heuristic) {
+                // Python heuristics need the GIL, return None for unsolvable states
+                options.heuristic = [&heuristic](const T &s) {
+                    const py::gil_scoped_acquire acquire;
+                    const py::object value = (*heuristic)(s);
+                    return value.is_none() ? sokoban::kInfiniteCost : value.cast<int>();
+                };
+            }
+            const py::gil_scoped_release release;
+            return sokoban::solve(state, options);
+        },
+        py::arg("state"), py::arg("algorithm") = sokoban::SearchAlgorithm::kAStar, py::arg("heuristic") = py::none(),
+        py::arg("max_expansions") = 0, py::arg("max_memory_bytes") = 0, py::arg("prune_deadlocks") = true,
+        py::arg("transposition_table") = py::none(), py::arg("num_threads") = 0);
+
+    using VecEnv = sokoban::SokobanVecEnv;
+    py::class_<VecEnv>(m, "SokobanVecEnv")
+        .def(py::init<std::vector<T>, int, uint64_t, bool, int>(), py::arg("levels"), py::arg("num_envs"),
+             py::arg("seed") = 0, py::arg("compact") = false, py::arg("num_threads") = 1)
+        .def(py::init([](const std::vector<std::string> &levels, int num_envs, uint64_t seed, bool compact,
+                         int num_threads) {
+                 std::vector<T> level_pool;
+                 level_pool.reserve(levels.size());
+                 for (const auto &board_str : levels) {
+                     level_pool.emplace_back(board_str);
+                 }
+                 return VecEnv(std::move(level_pool), num_envs, seed, compact, num_threads);
+             }),
+             py::arg("levels"), py::arg("num_envs"), py::arg("seed") = 0, py::arg("compact") = false,
+             py::arg("num_threads") = 1)
+        .def_property_readonly("num_envs", &VecEnv::num_envs)
+        .def_property_readonly("num_threads", &VecEnv::num_threads)
+        .def("observation_shape", &VecEnv::observation_shape)
+        .def("reset",
+             [](VecEnv &self) {
+                 py::array_t<float> obs(batch_observation_shape(self));
+                 float *obs_data = obs.mutable_data();
+                 {
+                     const py::gil_scoped_release release;
+                     self.reset(obs_data);
+                 }
+                 return obs;
+             })
+        .def("observe",
+             [](const VecEnv &self) {
+                 py::array_t<float> obs(batch_observation_shape(self));
+                 float *obs_data = obs.mutable_data();
+                 {
+                     const py::gil_scoped_release release;
+                     self.observe(obs_data);
+                 }
+                 return obs;
+             })
+        .def("step",
+             [](VecEnv &self, const py::array_t<int32_t, py::array::c_style | py::array::forcecast> &actions) {
+                 if (actions.ndim() != 1 || actions.shape(0) != self.num_envs()) {
+                     throw std::invalid_argument("Expected actions of shape (num_envs,).");
+                 }
+                 py::array_t<float> obs(batch_observation_shape(self));
+                 py::array_t<uint64_t> reward_signals(self.num_envs());
+                 py::array_t<bool> solved(self.num_envs());
+                 const int32_t *actions_data = actions.data();
+                 uint64_t *reward_signals_data = reward_signals.mutable_data();
+                 // NOLINTNEXTLINE(*-reinterpret-cast)
+                 auto *solved_data = reinterpret_cast<uint8_t *>(solved.mutable_data());
+                 float *obs_data = obs.mutable_data();
+                 {
+                     const py::gil_scoped_release release;
+                     self.step(actions_data, reward_signals_data, solved_data, obs_data);
+                 }
+                 return py::make_tuple(obs, reward_signals, solved);
+             })
+        .def("action_masks",
+             [](const VecEnv &self) {
+                 py::array_t<uint8_t> legal(self.num_envs());
+                 py::array_t<uint8_t> push(self.num_envs());
+                 uint8_t *legal_data = legal.mutable_data();
+                 uint8_t *push_data = push.mutable_data();
+                 {
+                     const py::gil_scoped_release release;
+                     self.action_masks(legal_data, push_data);
+                 }
+                 return py::make_tuple(legal, push);
+             })
+        .def("get_state", &VecEnv::get_state)
+        .def("get_states", &VecEnv::get_states);
+
+    using sokoban::MCTSResult;
+    py::class_<MCTSResult>(m, "MCTSResult")
+        .def_readonly("visit_counts", &MCTSResult::visit_counts)
+        .def_readonly("q_values", &MCTSResult::q_values)
+        .def_readonly("root_value", &MCTSResult::root_value)
+        .def_property_readonly("best_action",
+                               [](const MCTSResult &self) { return static_cast<int>(self.best_action); })
+        .def_readonly("num_simulations", &MCTSResult::num_simulations)
+        .def_readonly("num_evaluations", &MCTSResult::num_evaluations)
+        .def_readonly("num_batches", &MCTSResult::num_batches)
+        .def_readonly("num_collisions", &MCTSResult::num_collisions)
+        .def_readonly("max_depth", &MCTSResult::max_depth)
+        .def_readonly("num_nodes", &MCTSResult::num_nodes);
+
+    using sokoban::MCTS;
+    py::class_<MCTS>(m, "MCTS")
+        .def(py::init([](int num_simulations, int batch_size, int num_threads, float c_puct, float virtual_loss,
+                         float discount, float solved_value, float deadlock_value, bool terminate_deadlocks,
+                         bool compact) {
+                 sokoban::MCTSOptions options;
+                 options.num_simulations = num_simulations;
+                 options.batch_size = batch_size;
+                 options.num_threads = num_threads;
+                 options.c_puct = c_puct;
+                 options.virtual_loss = virtual_loss;
+                 options.discount = discount;
+                 options.solved_value = solved_value;
+                 options.deadlock_value = deadlock_value;
+                 options.terminate_deadlocks = terminate_deadlocks;
+                 options.compact = compact;
+                 return MCTS(options);
+             }),
+             py::arg("num_simulations") = 800, py::arg("batch_size") = 8, py::arg("num_threads") = 1,
+             py::arg("c_puct") = 1.25F, py::arg("virtual_loss") = 1.0F, py::arg("discount") = 1.0F,
+             py::arg("solved_value") = 1.0F, py::arg("deadlock_value") = -1.0F, py::arg("terminate_deadlocks") = true,
+             py::arg("compact") = true)
+        .def_property_readonly("arena_capacity", &MCTS::get_arena_capacity)
+        .def(
+            "search",
+            [](MCTS &self, const T &state, const py::function &evaluator) {
+                const auto obs_shape = state.observation_shape(self.get_options().compact);
+                const auto obs_size = static_cast<std::size_t>(obs_shape[0] * obs_shape[1] * obs_shape[2]);
+                // Called on this thread, the evaluator gets a (count, C, H, W) batch and returns priors of shape
+                // (count, 4) and values of shape (count,)
+                const sokoban::LeafEvaluator leaf_evaluator = [&](const float *observations, std::size_t count,
+                                                                  float *priors, float *values) {
+                    const py::gil_scoped_acquire acquire;
+                    const auto batch = static_cast<py::ssize_t>(count);
+                    py::array_t<float> obs({batch, static_cast<py::ssize_t>(obs_shape[0]),
+                                            static_cast<py::ssize_t>(obs_shape[1]),
+                                            static_cast<py::ssize_t>(obs_shape[2])});
+                    std::copy_n(observations, count * obs_size, obs.mutable_data());
+                    const auto out = evaluator(obs).cast<py::tuple>();
+                    if (out.size() != 2) {
+                        throw std::invalid_argument("Expected the evaluator to return (priors, values).");
+                    }
+                    using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+                    const auto out_priors = out[0].cast<FloatArray>();
+                    const auto out_values = out[1].cast<FloatArray>();
+                    if (out_priors.ndim() != 2 || out_priors.shape(0) != batch ||
+                        out_priors.shape(1) != sokoban::kNumActions) {
+                        throw std::invalid_argument("Expected priors of shape (count, 4).");
+                    }
+                    if (out_values.ndim() != 1 || out_values.shape(0) != batch) {
+                        throw std::invalid_argument("Expected values of shape (count,).");
+                    }
+                    std::copy_n(out_priors.data(), count * sokoban::kNumActions, priors);
+                    std::copy_n(out_values.data(), count, values);
+                };
+                const py::gil_scoped_release release;
+                return self.search(state, leaf_evaluator);
+            },
+            py::arg("state"), py::arg("evaluator"));
 }
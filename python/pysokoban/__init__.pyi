@@ -1,8 +1,29 @@
-from typing import ClassVar
+from enum import Enum
+from typing import Callable, ClassVar, overload
 
 import numpy
 from numpy.typing import NDArray
 
+class ObservationFormat(Enum):
+    FLOAT = 0
+    UINT8 = 1
+    CELL_CODE = 2
+    BIT_PACKED = 3
+
+REWARD_BOX_IN_GOAL: int
+REWARD_ALL_BOXES_IN_GOAL: int
+REWARD_DEADLOCK: int
+
+class UndoRecord:
+    @property
+    def agent_index(self) -> int: ...
+    @property
+    def box_from(self) -> int: ...
+    @property
+    def box_to(self) -> int: ...
+    @property
+    def reward_signal(self) -> int: ...
+
 class SokobanGameState:
     name: ClassVar[str] = ...  # read-only
     num_actions: ClassVar[int] = ...  # read-only
@@ -12,16 +33,279 @@ class SokobanGameState:
     def __eq__(self, other: object) -> bool: ...
     def __hash__(self) -> int: ...
     def __ne__(self, other: object) -> bool: ...
+    def serialize(self) -> bytes: ...
+    @staticmethod
+    def deserialize(data: bytes) -> SokobanGameState: ...
     def apply_action(self, int: int) -> None: ...
+    def apply_push(self, agent_cell: int, action: int) -> None: ...
+    def apply_action_undoable(self, action: int) -> UndoRecord: ...
+    def apply_push_undoable(self, agent_cell: int, action: int) -> UndoRecord: ...
+    def undo_action(self, undo: UndoRecord) -> None: ...
+    def legal_action_mask(self) -> int: ...
+    def push_action_mask(self) -> int: ...
     def is_solution(self) -> bool: ...
     def is_terminal(self) -> bool: ...
+    def is_deadlocked(self) -> bool: ...
+    def is_box_deadlocked(self, box_index: int) -> bool: ...
+    def set_deadlock_signal(self, enabled: bool) -> None: ...
+    def is_deadlock_signal_enabled(self) -> bool: ...
+    def get_push_distances(self) -> NDArray[numpy.int32]: ...
+    def get_dead_squares(self) -> list[int]: ...
+    @overload
     def observation_shape(self) -> tuple[int, int, int]: ...
-    def get_observation(self) -> NDArray[numpy.float32]: ...
-    def image_shape(self) -> tuple[int, int, int]: ...
-    def to_image(self) -> NDArray[numpy.uint8]: ...
+    @overload
+    def observation_shape(self, compact: bool) -> tuple[int, int, int]: ...
+    @overload
+    def observation_shape(self, format: ObservationFormat, compact: bool = False) -> tuple[int, int, int]: ...
+    @overload
+    def get_observation(
+        self, compact: bool = False, format: ObservationFormat = ObservationFormat.FLOAT
+    ) -> NDArray[numpy.float32] | NDArray[numpy.uint8]: ...
+    @overload
+    def get_observation(
+        self,
+        out: NDArray[numpy.float32] | NDArray[numpy.uint8],
+        compact: bool = False,
+        format: ObservationFormat = ObservationFormat.FLOAT,
+    ) -> NDArray[numpy.float32] | NDArray[numpy.uint8]: ...
+    def image_shape(self, tile_size: int = 32, grayscale: bool = False) -> tuple[int, int, int]: ...
+    def to_image(self, tile_size: int = 32, grayscale: bool = False) -> NDArray[numpy.uint8]: ...
     def get_reward_signal(self) -> int: ...
     def get_agent_index(self) -> int: ...
     def get_box_indices(self) -> list[int]: ...
     def get_empty_goal_indices(self) -> list[int]: ...
     def get_solved_goal_indices(self) -> list[int]: ...
     def get_all_goal_indices(self) -> list[int]: ...
+
+class Renderer:
+    def __init__(self, tile_size: int = 32, grayscale: bool = False) -> None: ...
+    @property
+    def tile_size(self) -> int: ...
+    @property
+    def grayscale(self) -> bool: ...
+    def render(self, state: SokobanGameState) -> NDArray[numpy.uint8]: ...
+
+class LevelStore:
+    def __init__(self) -> None: ...
+    @staticmethod
+    def from_file(path: str) -> LevelStore: ...
+    @staticmethod
+    def from_string(text: str) -> LevelStore: ...
+    def add(self, board_str: str) -> None: ...
+    def __len__(self) -> int: ...
+    def __getitem__(self, index: int) -> SokobanGameState: ...
+    def get_rows(self, index: int) -> int: ...
+    def get_cols(self, index: int) -> int: ...
+    def get_states(self) -> list[SokobanGameState]: ...
+    @property
+    def memory_bytes(self) -> int: ...
+
+class StateArchive:
+    def __init__(self, path: str) -> None: ...
+    @staticmethod
+    def write(path: str, states: list[SokobanGameState]) -> None: ...
+    def __len__(self) -> int: ...
+    def __getitem__(self, index: int) -> SokobanGameState: ...
+
+class StatePool:
+    def __init__(
+        self, prototype: SokobanGameState, max_memory_bytes: int = 0, states_per_slab: int = 65536
+    ) -> None: ...
+    def push(self, state: SokobanGameState) -> int | None: ...
+    def get(self, handle: int) -> SokobanGameState: ...
+    def load(self, handle: int, out: SokobanGameState) -> None: ...
+    def get_agent_index(self, handle: int) -> int: ...
+    def get_hash(self, handle: int) -> int: ...
+    def is_solution(self, handle: int) -> bool: ...
+    def clear(self) -> None: ...
+    def __len__(self) -> int: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def memory_bytes(self) -> int: ...
+    @property
+    def record_bytes(self) -> int: ...
+
+def serialize_states(states: list[SokobanGameState]) -> NDArray[numpy.uint8]: ...
+def deserialize_states(data: NDArray[numpy.uint8]) -> list[SokobanGameState]: ...
+def action_masks(states: list[SokobanGameState]) -> tuple[NDArray[numpy.uint8], NDArray[numpy.uint8]]: ...
+
+class PushGenerator:
+    def __init__(self) -> None: ...
+    def generate(self, state: SokobanGameState) -> None: ...
+    def get_reachable(self) -> list[int]: ...
+    def get_pushes(self) -> list[tuple[int, int, int]]: ...
+    def get_canonical_key(self) -> int: ...
+    def get_walk(self, target_cell: int) -> list[int]: ...
+
+@overload
+def manhattan_heuristic(state: SokobanGameState) -> int | None: ...
+@overload
+def manhattan_heuristic(state: list[SokobanGameState]) -> NDArray[numpy.int32]: ...
+@overload
+def greedy_heuristic(state: SokobanGameState) -> int | None: ...
+@overload
+def greedy_heuristic(state: list[SokobanGameState]) -> NDArray[numpy.int32]: ...
+@overload
+def matching_heuristic(state: SokobanGameState) -> int | None: ...
+@overload
+def matching_heuristic(state: list[SokobanGameState]) -> NDArray[numpy.int32]: ...
+
+class MatchingHeuristic:
+    def __init__(self) -> None: ...
+    def reset(self, state: SokobanGameState) -> int | None: ...
+    def evaluate_move(self, box_cell: int, box_new_cell: int) -> int | None: ...
+    def move_box(self, box_cell: int, box_new_cell: int) -> int | None: ...
+    def get_cost(self) -> int | None: ...
+
+class ReplacementPolicy(Enum):
+    KEEP_EXISTING = 0
+    REPLACE_HIGHEST_COST = 1
+    ALWAYS_REPLACE = 2
+
+class InsertResult(Enum):
+    INSERTED = 0
+    IMPROVED = 1
+    DUPLICATE = 2
+    REPLACED = 3
+    DROPPED = 4
+
+class TranspositionTable:
+    def __init__(
+        self, max_memory_bytes: int, policy: ReplacementPolicy = ReplacementPolicy.REPLACE_HIGHEST_COST
+    ) -> None: ...
+    def insert(
+        self, key: int, g: int, parent_key: int = 0, push: tuple[int, int, int] | None = None
+    ) -> InsertResult: ...
+    def find(self, key: int) -> tuple[int, int, tuple[int, int, int]] | None: ...
+    def __contains__(self, key: int) -> bool: ...
+    def __len__(self) -> int: ...
+    def clear(self) -> None: ...
+    def rehash(self, max_memory_bytes: int) -> None: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def memory_bytes(self) -> int: ...
+    @property
+    def policy(self) -> ReplacementPolicy: ...
+
+class SearchAlgorithm(Enum):
+    ASTAR = 0
+    IDASTAR = 1
+    HDASTAR = 2
+
+class SolverStatus(Enum):
+    SOLVED = 0
+    UNSOLVABLE = 1
+    LIMIT_REACHED = 2
+
+class SolverStats:
+    @property
+    def expanded(self) -> int: ...
+    @property
+    def generated(self) -> int: ...
+    @property
+    def duplicates(self) -> int: ...
+    @property
+    def pruned(self) -> int: ...
+    @property
+    def iterations(self) -> int: ...
+    @property
+    def messages(self) -> int: ...
+    @property
+    def peak_memory_bytes(self) -> int: ...
+    @property
+    def elapsed_seconds(self) -> float: ...
+
+class SolverResult:
+    @property
+    def status(self) -> SolverStatus: ...
+    @property
+    def actions(self) -> list[int]: ...
+    @property
+    def num_pushes(self) -> int: ...
+    @property
+    def stats(self) -> SolverStats: ...
+
+def solve(
+    state: SokobanGameState,
+    algorithm: SearchAlgorithm = SearchAlgorithm.ASTAR,
+    heuristic: Callable[[SokobanGameState], int | None] | None = None,
+    max_expansions: int = 0,
+    max_memory_bytes: int = 0,
+    prune_deadlocks: bool = True,
+    transposition_table: TranspositionTable | None = None,
+    num_threads: int = 0,
+) -> SolverResult: ...
+
+class SokobanVecEnv:
+    @overload
+    def __init__(
+        self,
+        levels: list[SokobanGameState],
+        num_envs: int,
+        seed: int = 0,
+        compact: bool = False,
+        num_threads: int = 1,
+    ) -> None: ...
+    @overload
+    def __init__(
+        self, levels: list[str], num_envs: int, seed: int = 0, compact: bool = False, num_threads: int = 1
+    ) -> None: ...
+    @property
+    def num_envs(self) -> int: ...
+    @property
+    def num_threads(self) -> int: ...
+    def observation_shape(self) -> tuple[int, int, int]: ...
+    def reset(self) -> NDArray[numpy.float32]: ...
+    def observe(self) -> NDArray[numpy.float32]: ...
+    def step(
+        self, actions: NDArray[numpy.int32]
+    ) -> tuple[NDArray[numpy.float32], NDArray[numpy.uint64], NDArray[numpy.bool_]]: ...
+    def action_masks(self) -> tuple[NDArray[numpy.uint8], NDArray[numpy.uint8]]: ...
+    def get_state(self, index: int) -> SokobanGameState: ...
+    def get_states(self) -> list[SokobanGameState]: ...
+
+class MCTSResult:
+    @property
+    def visit_counts(self) -> list[int]: ...
+    @property
+    def q_values(self) -> list[float]: ...
+    @property
+    def root_value(self) -> float: ...
+    @property
+    def best_action(self) -> int: ...
+    @property
+    def num_simulations(self) -> int: ...
+    @property
+    def num_evaluations(self) -> int: ...
+    @property
+    def num_batches(self) -> int: ...
+    @property
+    def num_collisions(self) -> int: ...
+    @property
+    def max_depth(self) -> int: ...
+    @property
+    def num_nodes(self) -> int: ...
+
+class MCTS:
+    def __init__(
+        self,
+        num_simulations: int = 800,
+        batch_size: int = 8,
+        num_threads: int = 1,
+        c_puct: float = 1.25,
+        virtual_loss: float = 1.0,
+        discount: float = 1.0,
+        solved_value: float = 1.0,
+        deadlock_value: float = -1.0,
+        terminate_deadlocks: bool = True,
+        compact: bool = True,
+    ) -> None: ...
+    @property
+    def arena_capacity(self) -> int: ...
+    def search(
+        self,
+        state: SokobanGameState,
+        evaluator: Callable[[NDArray[numpy.float32]], tuple[NDArray[numpy.float32], NDArray[numpy.float32]]],
+    ) -> MCTSResult: ...
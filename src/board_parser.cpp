@@ -0,0 +1,89 @@
+#include "board_parser.h"
+
+#include <sokoban/definitions.h>
+
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace sokoban {
+
+namespace {
+constexpr char kSeparator = '|';
+
+void validate_size(int rows, int cols) {
+    if (rows < 1 || cols < 1) {
+        throw std::invalid_argument("rows and/or cols < 1");
+    }
+    if (cols > kMaxCells / rows) {
+        throw std::invalid_argument("Level has more cells than SOKOBAN_MAX_CELLS");
+    }
+}
+}    // namespace
+
+auto parse_board(std::string_view board_str, std::vector<uint8_t>& codes) -> std::pair<int, int> {
+    while (!board_str.empty() && std::isspace(static_cast<unsigned char>(board_str.back())) != 0) {
+        board_str.remove_suffix(1);
+    }
+    const char* it = board_str.data();
+    const char* const end = it + board_str.size();
+    // Read one number and step over its separator
+    auto next_field = [&]() -> int {
+        int value = 0;
+        const auto [ptr, ec] = std::from_chars(it, end, value);
+        if (ec != std::errc() || (ptr != end && *ptr != kSeparator)) {
+            throw std::invalid_argument("Invalid field in board string: " + std::string(board_str));
+        }
+        it = ptr == end ? end : ptr + 1;
+        return value;
+    };
+
+    const int rows = next_field();
+    const int cols = next_field();
+    validate_size(rows, cols);
+    const int num_cells = rows * cols;
+    for (int i = 0; i < num_cells; ++i) {
+        if (it == end) {
+            throw std::invalid_argument("Missmatch in board elements");
+        }
+        const int code = next_field();
+        if (code < 0 || code > UINT8_MAX) {
+            throw std::invalid_argument("Unknown element type: " + std::to_string(code));
+        }
+        codes.push_back(static_cast<uint8_t>(code));
+    }
+    if (it != end) {
+        throw std::invalid_argument("Missmatch in board elements");
+    }
+    return {rows, cols};
+}
+
+void validate_board(int rows, int cols, std::span<const uint8_t> codes) {
+    validate_size(rows, cols);
+    if (codes.size() != static_cast<std::size_t>(rows * cols)) {
+        throw std::invalid_argument("Missmatch in board elements");
+    }
+    int agent_counter = 0;
+    int box_counter = 0;
+    int goal_counter = 0;
+    for (const auto code : codes) {
+        if (code >= kNumElements) {
+            throw std::invalid_argument("Unknown element type: " + std::to_string(code));
+        }
+        agent_counter += code == static_cast<uint8_t>(Element::kAgent) ? 1 : 0;
+        box_counter += code == static_cast<uint8_t>(Element::kBox) ? 1 : 0;
+        goal_counter += code == static_cast<uint8_t>(Element::kGoal) ? 1 : 0;
+    }
+    if (box_counter != goal_counter) {
+        throw std::invalid_argument("Missmatch in number of boxes and goals");
+    }
+    if (agent_counter == 0) {
+        throw std::invalid_argument("Agent element not found");
+    }
+    if (agent_counter > 1) {
+        throw std::invalid_argument("Too many agent elements, expected only one");
+    }
+}
+
+}    // namespace sokoban
@@ -0,0 +1,34 @@
+#ifndef SOKOBAN_BOARD_PARSER_H_
+#define SOKOBAN_BOARD_PARSER_H_
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sokoban {
+
+/**
+ * Parse a board string of the form rows|cols|code|code|... in a single pass, without allocating per field.
+ * A trailing separator and trailing whitespace (such as the \r of Windows line endings) are ignored.
+ * @param board_str Board string, see SokobanGameState(const std::string&) for the element codes
+ * @param codes Element codes in row major order are appended to this
+ * @return Rows and cols of the board
+ * @throws std::invalid_argument if a field isn't a number or the number of codes doesn't match the size
+ */
+auto parse_board(std::string_view board_str, std::vector<uint8_t>& codes) -> std::pair<int, int>;
+
+/**
+ * Check a board can be turned into a state: size within limits, known element codes, one agent, and as many boxes
+ * as goals.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param codes rows * cols element codes in row major order
+ * @throws std::invalid_argument describing the first problem found
+ */
+void validate_board(int rows, int cols, std::span<const uint8_t> codes);
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_BOARD_PARSER_H_
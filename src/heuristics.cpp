@@ -0,0 +1,181 @@
+#include <sokoban/heuristics.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace sokoban {
+
+namespace {
+constexpr int kInfiniteSlack = std::numeric_limits<int>::max();
+}    // namespace
+
+auto manhattan_heuristic(const SokobanGameState& state) -> int {
+    const auto& level = *state.get_level();
+    const int cols = level.get_cols();
+    int total = 0;
+    state.get_box_bitboard().for_each([&](int box) {
+        int closest = kInfiniteCost;
+        for (const int goal : level.get_goal_indices()) {
+            const int distance = std::abs((box / cols) - (goal / cols)) + std::abs((box % cols) - (goal % cols));
+            closest = std::min(closest, distance);
+        }
+        total += closest;
+    });
+    return total;
+}
+
+auto greedy_heuristic(const SokobanGameState& state) -> int {
+    const auto& level = *state.get_level();
+    int total = 0;
+    bool reachable = true;
+    state.get_box_bitboard().for_each([&](int box) {
+        const int distance = level.get_closest_goal_distance(box);
+        reachable = reachable && distance != kUnreachable;
+        total += reachable ? distance : 0;
+    });
+    return reachable ? total : kInfiniteCost;
+}
+
+auto matching_heuristic(const SokobanGameState& state) -> int {
+    return MatchingHeuristic().reset(state);
+}
+
+// ---------------------------------------------------------------------------
+
+auto MatchingHeuristic::reset(const SokobanGameState& state) -> int {
+    level = state.get_level().get();
+    num_rows = state.get_box_bitboard().count();
+    num_cols = static_cast<int>(level->get_goal_indices().size());
+    // Larger than any matching of reachable goals, so unreachable pairs are only used when nothing else is possible
+    unreachable_cost = (level->get_flat_size() * num_cols) + 1;
+
+    const auto rows = static_cast<std::size_t>(num_rows + 1);
+    const auto cols = static_cast<std::size_t>(num_cols + 1);
+    current.box_cells.assign(rows, kNoCell);
+    current.costs.assign(rows * cols, 0);
+    current.row_potential.assign(rows, 0);
+    current.col_potential.assign(cols, 0);
+    current.col_match.assign(cols, 0);
+    min_slack.resize(cols);
+    way.resize(cols);
+    used.resize(cols);
+    // More boxes than goals can't be matched
+    if (num_rows > num_cols) {
+        return kInfiniteCost;
+    }
+
+    int row = 0;
+    state.get_box_bitboard().for_each([&](int box_cell) { SetRow(current, ++row, box_cell); });
+    for (row = 1; row <= num_rows; ++row) {
+        AssignRow(current, row);
+    }
+    return get_cost();
+}
+
+auto MatchingHeuristic::evaluate_move(int box_cell, int box_new_cell) -> int {
+    scratch = current;
+    return MoveBox(scratch, box_cell, box_new_cell);
+}
+
+auto MatchingHeuristic::move_box(int box_cell, int box_new_cell) -> int {
+    return MoveBox(current, box_cell, box_new_cell);
+}
+
+auto MatchingHeuristic::get_cost() const noexcept -> int {
+    return num_rows > num_cols ? kInfiniteCost : Cost(current);
+}
+
+void MatchingHeuristic::SetRow(Matching& matching, int row, int box_cell) const noexcept {
+    matching.box_cells[static_cast<std::size_t>(row)] = box_cell;
+    int* costs = &matching.costs[static_cast<std::size_t>(row * (num_cols + 1))];
+    for (int col = 1; col <= num_cols; ++col) {
+        const int distance = level->get_push_distance(col - 1, box_cell);
+        costs[col] = distance == kUnreachable ? unreachable_cost : distance;
+    }
+}
+
+// Shortest augmenting path from the free row, updating potentials so matched pairs keep zero reduced cost
+void MatchingHeuristic::AssignRow(Matching& matching, int row) {
+    auto& [box_cells, costs, row_potential, col_potential, col_match] = matching;
+    const auto cols = static_cast<std::size_t>(num_cols + 1);
+    std::fill(min_slack.begin(), min_slack.end(), kInfiniteSlack);
+    std::fill(used.begin(), used.end(), false);
+    col_match[0] = row;
+    std::size_t col = 0;
+    do {
+        used[col] = true;
+        const auto matched_row = static_cast<std::size_t>(col_match[col]);
+        int delta = kInfiniteSlack;
+        std::size_t next_col = 0;
+        for (std::size_t j = 1; j < cols; ++j) {
+            if (used[j]) {
+                continue;
+            }
+            const int slack = costs[(matched_row * cols) + j] - row_potential[matched_row] - col_potential[j];
+            if (slack < min_slack[j]) {
+                min_slack[j] = slack;
+                way[j] = static_cast<int>(col);
+            }
+            if (min_slack[j] < delta) {
+                delta = min_slack[j];
+                next_col = j;
+            }
+        }
+        for (std::size_t j = 0; j < cols; ++j) {
+            if (used[j]) {
+                row_potential[static_cast<std::size_t>(col_match[j])] += delta;
+                col_potential[j] -= delta;
+            } else {
+                min_slack[j] -= delta;
+            }
+        }
+        col = next_col;
+    } while (col_match[col] != 0);
+    // Flip the matching along the augmenting path
+    do {
+        const auto prev_col = static_cast<std::size_t>(way[col]);
+        col_match[col] = col_match[prev_col];
+        col = prev_col;
+    } while (col != 0);
+}
+
+auto MatchingHeuristic::Cost(const Matching& matching) const noexcept -> int {
+    const auto cols = static_cast<std::size_t>(num_cols + 1);
+    int total = 0;
+    for (std::size_t col = 1; col < cols; ++col) {
+        const auto row = static_cast<std::size_t>(matching.col_match[col]);
+        total += row == 0 ? 0 : matching.costs[(row * cols) + col];
+    }
+    return total >= unreachable_cost ? kInfiniteCost : total;
+}
+
+auto MatchingHeuristic::MoveBox(Matching& matching, int box_cell, int box_new_cell) -> int {
+    if (num_rows > num_cols) {
+        return kInfiniteCost;
+    }
+    const auto it = std::find(matching.box_cells.begin() + 1, matching.box_cells.end(), box_cell);
+    if (it == matching.box_cells.end() || box_new_cell < 0 || box_new_cell >= level->get_flat_size()) {
+        throw std::invalid_argument("Invalid box move");
+    }
+    const auto row = static_cast<int>(it - matching.box_cells.begin());
+    SetRow(matching, row, box_new_cell);
+    if (num_rows < num_cols) {
+        // Free goals must keep zero potential for the matching to be optimal, which removing a row can break
+        std::fill(matching.row_potential.begin(), matching.row_potential.end(), 0);
+        std::fill(matching.col_potential.begin(), matching.col_potential.end(), 0);
+        std::fill(matching.col_match.begin(), matching.col_match.end(), 0);
+        for (int r = 1; r <= num_rows; ++r) {
+            AssignRow(matching, r);
+        }
+    } else {
+        // Only the moved box's costs changed, unassign it and find one augmenting path. Other rows keep feasible
+        // potentials, and a zero potential is feasible for the moved box as column potentials never increase.
+        std::replace(matching.col_match.begin() + 1, matching.col_match.end(), row, 0);
+        matching.row_potential[static_cast<std::size_t>(row)] = 0;
+        AssignRow(matching, row);
+    }
+    return Cost(matching);
+}
+
+}    // namespace sokoban
@@ -0,0 +1,122 @@
+#include <sokoban/level.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace sokoban {
+
+namespace {
+// https://en.wikipedia.org/wiki/Xorshift
+// Portable RNG Seed
+constexpr uint64_t SPLIT64_S1 = 30;
+constexpr uint64_t SPLIT64_S2 = 27;
+constexpr uint64_t SPLIT64_S3 = 31;
+constexpr uint64_t SPLIT64_C1 = 0x9E3779B97f4A7C15;
+constexpr uint64_t SPLIT64_C2 = 0xBF58476D1CE4E5B9;
+constexpr uint64_t SPLIT64_C3 = 0x94D049BB133111EB;
+auto to_local_hash(int flat_size, Element el, int offset) noexcept -> uint64_t {
+    auto seed = static_cast<uint64_t>((flat_size * static_cast<int>(el)) + offset);
+    uint64_t result = seed + SPLIT64_C1;
+    result = (result ^ (result >> SPLIT64_S1)) * SPLIT64_C2;
+    result = (result ^ (result >> SPLIT64_S2)) * SPLIT64_C3;
+    return result ^ (result >> SPLIT64_S3);
+}
+}    // namespace
+
+Level::Level(int rows, int cols, std::vector<Element> board_static)
+    : rows(rows), cols(cols), board_static(std::move(board_static)) {
+    if (rows < 1 || cols < 1) {
+        throw std::invalid_argument("rows and/or cols < 1");
+    }
+    if (rows * cols > kMaxCells) {
+        throw std::invalid_argument("Level has more cells than SOKOBAN_MAX_CELLS");
+    }
+    if (this->board_static.size() != static_cast<std::size_t>(rows * cols)) {
+        throw std::invalid_argument("Missmatch in board elements");
+    }
+    for (int i = 0; i < rows * cols; ++i) {
+        board_mask.set(i);
+        if (is_goal(i)) {
+            goal_indices.push_back(i);
+            goal_mask.set(i);
+        } else if (is_wall(i)) {
+            wall_mask.set(i);
+        }
+    }
+
+    // Zobrist keys, generated once and shared by every state of the level
+    const int flat_size = rows * cols;
+    agent_keys.reserve(static_cast<std::size_t>(flat_size));
+    box_keys.reserve(static_cast<std::size_t>(flat_size));
+    for (int i = 0; i < flat_size; ++i) {
+        agent_keys.push_back(to_local_hash(flat_size, Element::kAgent, i));
+        box_keys.push_back(to_local_hash(flat_size, Element::kBox, i));
+        static_hash ^= to_local_hash(flat_size, get_element(i), i);
+    }
+
+    // Neighbour table, so stepping never needs to recover row/col with a division
+    neighbours.assign(static_cast<std::size_t>(rows * cols * kNumActions), kNoCell);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const int index = (row * cols) + col;
+            for (int a = 0; a < kNumActions; ++a) {
+                const auto& offsets = kActionOffsets[static_cast<std::size_t>(a)];    // NOLINT(*-array-index)
+                const int new_col = col + offsets.first;
+                const int new_row = row + offsets.second;
+                if (new_col < 0 || new_col >= cols || new_row < 0 || new_row >= rows) {
+                    continue;
+                }
+                const int new_index = (new_row * cols) + new_col;
+                if (!is_wall(new_index)) {
+                    neighbours[static_cast<std::size_t>((index * kNumActions) + a)] = new_index;
+                }
+            }
+        }
+    }
+
+    // Push distances, breadth first search from each goal pulling the box backwards. A box on cell is pulled to next
+    // if the agent stands on next and can step back once more. Other boxes are ignored, so distances are lower bounds.
+    const auto num_goals = goal_indices.size();
+    push_distances.assign(num_goals * static_cast<std::size_t>(flat_size), kUnreachable);
+    closest_goal_distances.assign(static_cast<std::size_t>(flat_size), kUnreachable);
+    std::vector<int> queue;
+    queue.reserve(static_cast<std::size_t>(flat_size));
+    for (std::size_t goal = 0; goal < num_goals; ++goal) {
+        int* distances = &push_distances[goal * static_cast<std::size_t>(flat_size)];
+        distances[goal_indices[goal]] = 0;
+        queue.assign(1, goal_indices[goal]);
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            const int cell = queue[i];
+            for (int a = 0; a < kNumActions; ++a) {
+                const auto action = static_cast<Action>(a);
+                const int next = get_neighbour(cell, action);
+                if (next != kNoCell && distances[next] == kUnreachable && get_neighbour(next, action) != kNoCell) {
+                    distances[next] = distances[cell] + 1;
+                    queue.push_back(next);
+                }
+            }
+        }
+        for (int i = 0; i < flat_size; ++i) {
+            auto& closest = closest_goal_distances[static_cast<std::size_t>(i)];
+            closest = std::min(closest, distances[i]);
+        }
+    }
+
+    // Dead squares, floor cells from which no goal can be reached
+    for (int i = 0; i < flat_size; ++i) {
+        if (!is_wall(i) && get_closest_goal_distance(i) == kUnreachable) {
+            dead_mask.set(i);
+        }
+    }
+}
+
+auto Level::operator==(const Level& other) const noexcept -> bool {
+    return this == &other || (rows == other.rows && cols == other.cols && board_static == other.board_static);
+}
+
+auto Level::operator!=(const Level& other) const noexcept -> bool {
+    return !(*this == other);
+}
+
+}    // namespace sokoban
@@ -0,0 +1,98 @@
+#include <sokoban/level_store.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "board_parser.h"
+
+namespace sokoban {
+
+auto LevelStore::from_file(const std::string& path) -> LevelStore {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::invalid_argument("Can't open level file " + path);
+    }
+    // One read of the whole file, parsing then runs over memory
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        throw std::invalid_argument("Can't read level file " + path);
+    }
+    return from_string(text);
+}
+
+auto LevelStore::from_string(std::string_view text) -> LevelStore {
+    LevelStore store;
+    std::size_t line_number = 0;
+    while (!text.empty()) {
+        const auto newline = text.find('\n');
+        const auto line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+        ++line_number;
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+            continue;
+        }
+        try {
+            store.add(line);
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument("Level on line " + std::to_string(line_number) + ": " + e.what());
+        }
+    }
+    return store;
+}
+
+void LevelStore::add(std::string_view board_str) {
+    const std::size_t offset = codes.size();
+    try {
+        const auto [rows, cols] = parse_board(board_str, codes);
+        validate_board(rows, cols, std::span<const uint8_t>(codes).subspan(offset));
+        entries.push_back({offset, static_cast<uint16_t>(rows), static_cast<uint16_t>(cols)});
+    } catch (...) {
+        codes.resize(offset);
+        throw;
+    }
+}
+
+auto LevelStore::size() const noexcept -> std::size_t {
+    return entries.size();
+}
+
+auto LevelStore::get_rows(std::size_t index) const -> int {
+    return GetEntry(index).rows;
+}
+
+auto LevelStore::get_cols(std::size_t index) const -> int {
+    return GetEntry(index).cols;
+}
+
+auto LevelStore::get_codes(std::size_t index) const -> std::span<const uint8_t> {
+    const auto& entry = GetEntry(index);
+    return std::span<const uint8_t>(codes).subspan(entry.offset, static_cast<std::size_t>(entry.rows * entry.cols));
+}
+
+auto LevelStore::get_state(std::size_t index) const -> SokobanGameState {
+    const auto& entry = GetEntry(index);
+    return {entry.rows, entry.cols, get_codes(index)};
+}
+
+auto LevelStore::get_states() const -> std::vector<SokobanGameState> {
+    std::vector<SokobanGameState> states;
+    states.reserve(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        states.push_back(get_state(i));
+    }
+    return states;
+}
+
+auto LevelStore::get_memory_bytes() const noexcept -> std::size_t {
+    return (codes.capacity() * sizeof(uint8_t)) + (entries.capacity() * sizeof(Entry));
+}
+
+auto LevelStore::GetEntry(std::size_t index) const -> const Entry& {
+    if (index >= entries.size()) {
+        throw std::out_of_range("Level index out of range");
+    }
+    return entries[index];
+}
+
+}    // namespace sokoban
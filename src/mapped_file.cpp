@@ -0,0 +1,62 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOKOBAN_HAS_MMAP
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+namespace sokoban {
+
+#ifdef SOKOBAN_HAS_MMAP
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::invalid_argument("Can't open file " + path);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Can't stat file " + path);
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    // Mapping zero bytes fails, an empty file is left unmapped
+    void* mapped = size == 0 ? nullptr : ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::invalid_argument("Can't map file " + path);
+    }
+    begin = static_cast<const uint8_t*>(mapped);
+}
+
+MappedFile::~MappedFile() {
+    if (begin != nullptr) {
+        ::munmap(const_cast<uint8_t*>(begin), size);    // NOLINT(*-const-cast)
+    }
+}
+#else
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::invalid_argument("Can't open file " + path);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    begin = buffer.data();
+    size = buffer.size();
+}
+
+MappedFile::~MappedFile() = default;
+#endif
+
+auto MappedFile::data() const noexcept -> std::span<const uint8_t> {
+    return {begin, size};
+}
+
+}    // namespace sokoban
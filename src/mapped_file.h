@@ -0,0 +1,41 @@
+#ifndef SOKOBAN_MAPPED_FILE_H_
+#define SOKOBAN_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sokoban {
+
+// Read only view of a whole file. Memory mapped on POSIX systems, read into memory elsewhere.
+class MappedFile {
+public:
+    /**
+     * @param path Path of the file
+     * @throws std::invalid_argument if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    auto operator=(MappedFile&&) -> MappedFile& = delete;
+
+    /**
+     * Get the contents of the file.
+     * @return Bytes of the file, valid while this is alive
+     */
+    [[nodiscard]] auto data() const noexcept -> std::span<const uint8_t>;
+
+private:
+    const uint8_t* begin = nullptr;
+    std::size_t size = 0;
+    std::vector<uint8_t> buffer;    // Contents when not mapped
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_MAPPED_FILE_H_
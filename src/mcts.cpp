@@ -0,0 +1,277 @@
+#include <sokoban/mcts.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace sokoban {
+
+namespace {
+auto is_legal(uint8_t mask, int action) noexcept -> bool {
+    return (mask & (1U << static_cast<unsigned>(action))) != 0;
+}
+}    // namespace
+
+MCTS::MCTS(const MCTSOptions& options) : options(options) {
+    if (options.num_simulations < 1 || options.batch_size < 1) {
+        throw std::invalid_argument("num_simulations and batch_size must be positive");
+    }
+    if (!(options.discount > 0 && options.discount <= 1)) {
+        throw std::invalid_argument("discount must be in (0, 1]");
+    }
+    thread_pool = std::make_unique<ThreadPool>(options.num_threads);
+    selections.resize(static_cast<std::size_t>(options.batch_size));
+}
+
+MCTS::~MCTS() = default;
+MCTS::MCTS(MCTS&&) noexcept = default;
+auto MCTS::operator=(MCTS&&) noexcept -> MCTS& = default;
+
+auto MCTS::search(const SokobanGameState& state, const LeafEvaluator& evaluator) -> MCTSResult {
+    MCTSResult result;
+    const auto root_terminal = Classify(state, kNoCell);
+    if (root_terminal != Terminal::kNone) {
+        result.root_value = TerminalValue(root_terminal);
+        return result;
+    }
+
+    // Every simulation expands at most one node, so the arena never fills during the search
+    const auto capacity = 1 + (static_cast<std::size_t>(options.num_simulations) * kNumActions);
+    if (nodes.size() < capacity) {
+        nodes = std::vector<Node>(capacity);
+    }
+    num_nodes = 1;
+    InitNode(0, 1.0F);
+
+    const auto obs_shape = state.observation_shape(options.compact);
+    const auto obs_size = static_cast<std::size_t>(obs_shape[0] * obs_shape[1] * obs_shape[2]);
+    const auto batch_size = static_cast<std::size_t>(options.batch_size);
+    observations.resize(batch_size * obs_size);
+    priors.resize(batch_size * kNumActions);
+    values.resize(batch_size);
+
+    while (result.num_simulations < options.num_simulations) {
+        const auto remaining = static_cast<std::size_t>(options.num_simulations - result.num_simulations);
+        const auto count = std::min(batch_size, remaining);
+        thread_pool->parallel_for(count, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                Select(state, selections[i], &observations[i * obs_size]);
+            }
+        });
+
+        // Move the observations of leaves to evaluate to the front, in selection order
+        std::size_t num_eval = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& selection = selections[i];
+            if (selection.kind != LeafKind::kEvaluate) {
+                continue;
+            }
+            selection.eval_index = num_eval++;
+            if (selection.eval_index != i) {
+                std::memcpy(&observations[selection.eval_index * obs_size], &observations[i * obs_size],
+                            obs_size * sizeof(float));
+            }
+        }
+        if (num_eval > 0) {
+            std::fill_n(priors.begin(), num_eval * kNumActions, 0.0F);
+            std::fill_n(values.begin(), num_eval, 0.0F);
+            evaluator(observations.data(), num_eval, priors.data(), values.data());
+            ++result.num_batches;
+            result.num_evaluations += static_cast<int>(num_eval);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& selection = selections[i];
+            switch (selection.kind) {
+                case LeafKind::kCollision:
+                    RevertVirtualLoss(selection);
+                    ++result.num_collisions;
+                    continue;
+                case LeafKind::kTerminal:
+                    nodes[static_cast<std::size_t>(selection.path.back())].terminal = selection.terminal;
+                    Backup(selection, TerminalValue(selection.terminal));
+                    break;
+                case LeafKind::kEvaluate:
+                    Expand(selection, &priors[selection.eval_index * kNumActions]);
+                    Backup(selection, values[selection.eval_index]);
+                    break;
+            }
+            ++result.num_simulations;
+            result.max_depth = std::max(result.max_depth, static_cast<int>(selection.path.size()) - 1);
+        }
+    }
+
+    const auto& root = nodes[0];
+    result.root_value = root.value_sum.load(std::memory_order_relaxed) /
+                        static_cast<float>(root.visits.load(std::memory_order_relaxed));
+    int best = -1;
+    for (int a = 0; a < kNumActions; ++a) {
+        if (!is_legal(root.legal_mask, a)) {
+            continue;
+        }
+        const auto& child = nodes[static_cast<std::size_t>(root.first_child + a)];
+        const int visits = child.visits.load(std::memory_order_relaxed);
+        const auto index = static_cast<std::size_t>(a);
+        result.visit_counts[index] = visits;
+        result.q_values[index] =
+            visits > 0 ? options.discount * child.value_sum.load(std::memory_order_relaxed) / static_cast<float>(visits)
+                       : 0.0F;
+        const auto best_index = static_cast<std::size_t>(best);
+        if (best < 0 || visits > result.visit_counts[best_index] ||
+            (visits == result.visit_counts[best_index] && result.q_values[index] > result.q_values[best_index])) {
+            best = a;
+        }
+    }
+    result.best_action = best < 0 ? Action::kUp : static_cast<Action>(best);
+    result.num_nodes = num_nodes;
+    return result;
+}
+
+auto MCTS::get_options() const noexcept -> const MCTSOptions& {
+    return options;
+}
+
+auto MCTS::get_arena_capacity() const noexcept -> std::size_t {
+    return nodes.size();
+}
+
+void MCTS::InitNode(std::size_t index, float prior) noexcept {
+    auto& node = nodes[index];
+    node.visits.store(0, std::memory_order_relaxed);
+    node.value_sum.store(0, std::memory_order_relaxed);
+    node.pending.store(false, std::memory_order_relaxed);
+    node.prior = prior;
+    node.first_child = -1;
+    node.legal_mask = 0;
+    node.terminal = Terminal::kNone;
+}
+
+// Descend by PUCT from the root, adding virtual loss along the way, until a node which isn't expanded yet
+void MCTS::Select(const SokobanGameState& root, Selection& selection, float* observation) {
+    SokobanGameState state = root;
+    selection.path.clear();
+    selection.kind = LeafKind::kCollision;
+    selection.terminal = Terminal::kNone;
+    int32_t index = 0;
+    int pushed_box = kNoCell;
+    while (true) {
+        auto& node = nodes[static_cast<std::size_t>(index)];
+        selection.path.push_back(index);
+        node.visits.fetch_add(1, std::memory_order_relaxed);
+        node.value_sum.fetch_sub(options.virtual_loss, std::memory_order_relaxed);
+        if (node.terminal != Terminal::kNone) {
+            selection.kind = LeafKind::kTerminal;
+            selection.terminal = node.terminal;
+            return;
+        }
+        if (node.first_child >= 0) {
+            const int action = SelectChild(node);
+            const auto undo = state.apply_action_undoable(static_cast<Action>(action));
+            pushed_box = undo.box_to;
+            index = node.first_child + action;
+            continue;
+        }
+
+        // Leaf, states reached by several selections of the batch are classified by each, which agree
+        selection.terminal = Classify(state, pushed_box);
+        selection.legal_mask = state.legal_action_mask();
+        if (selection.terminal == Terminal::kNone && selection.legal_mask == 0) {
+            selection.terminal = Terminal::kDeadlocked;
+        }
+        if (selection.terminal != Terminal::kNone) {
+            selection.kind = LeafKind::kTerminal;
+        } else if (!node.pending.exchange(true, std::memory_order_relaxed)) {
+            selection.kind = LeafKind::kEvaluate;
+            state.write_observation(observation, options.compact);
+        }
+        return;
+    }
+}
+
+auto MCTS::SelectChild(const Node& node) const noexcept -> int {
+    const auto parent_visits = static_cast<float>(node.visits.load(std::memory_order_relaxed));
+    const float exploration = options.c_puct * std::sqrt(parent_visits);
+    int best = -1;
+    float best_score = 0;
+    for (int a = 0; a < kNumActions; ++a) {
+        if (!is_legal(node.legal_mask, a)) {
+            continue;
+        }
+        const auto& child = nodes[static_cast<std::size_t>(node.first_child + a)];
+        const int visits = child.visits.load(std::memory_order_relaxed);
+        // Unvisited children count as value 0, between solved and deadlocked
+        const float q = visits > 0 ? options.discount * child.value_sum.load(std::memory_order_relaxed) /
+                                         static_cast<float>(visits)
+                                   : 0.0F;
+        const float score = q + (exploration * child.prior / static_cast<float>(1 + visits));
+        if (best < 0 || score > best_score) {
+            best = a;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+// Allocate one child per action, with priors normalized over the legal actions
+void MCTS::Expand(const Selection& selection, const float* leaf_priors) noexcept {
+    auto& node = nodes[static_cast<std::size_t>(selection.path.back())];
+    float total = 0;
+    for (int a = 0; a < kNumActions; ++a) {
+        const float prior = leaf_priors[a];
+        if (is_legal(selection.legal_mask, a) && std::isfinite(prior) && prior > 0) {
+            total += prior;
+        }
+    }
+    const auto num_legal = static_cast<float>(std::popcount(selection.legal_mask));
+    const auto first_child = num_nodes;
+    num_nodes += kNumActions;
+    for (int a = 0; a < kNumActions; ++a) {
+        float prior = 0;
+        if (is_legal(selection.legal_mask, a)) {
+            // Fall back to uniform priors if the evaluator gave no usable weight to any legal action
+            const float weight = leaf_priors[a];
+            prior = total > 0 ? (std::isfinite(weight) && weight > 0 ? weight / total : 0.0F) : 1.0F / num_legal;
+        }
+        InitNode(first_child + static_cast<std::size_t>(a), prior);
+    }
+    node.legal_mask = selection.legal_mask;
+    node.first_child = static_cast<int32_t>(first_child);
+    node.pending.store(false, std::memory_order_relaxed);
+}
+
+// Replace the virtual loss along the path with the leaf value, discounted once per action from the leaf
+void MCTS::Backup(const Selection& selection, float value) noexcept {
+    for (auto it = selection.path.rbegin(); it != selection.path.rend(); ++it) {
+        nodes[static_cast<std::size_t>(*it)].value_sum.fetch_add(options.virtual_loss + value,
+                                                                  std::memory_order_relaxed);
+        value *= options.discount;
+    }
+}
+
+void MCTS::RevertVirtualLoss(const Selection& selection) noexcept {
+    for (const auto index : selection.path) {
+        auto& node = nodes[static_cast<std::size_t>(index)];
+        node.visits.fetch_sub(1, std::memory_order_relaxed);
+        node.value_sum.fetch_add(options.virtual_loss, std::memory_order_relaxed);
+    }
+}
+
+auto MCTS::Classify(const SokobanGameState& state, int pushed_box) const noexcept -> Terminal {
+    if (state.is_solution()) {
+        return Terminal::kSolved;
+    }
+    if (options.terminate_deadlocks && pushed_box != kNoCell && state.is_box_deadlocked(pushed_box)) {
+        return Terminal::kDeadlocked;
+    }
+    return Terminal::kNone;
+}
+
+auto MCTS::TerminalValue(Terminal terminal) const noexcept -> float {
+    return terminal == Terminal::kSolved ? options.solved_value : options.deadlock_value;
+}
+
+}    // namespace sokoban
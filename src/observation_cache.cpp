@@ -0,0 +1,30 @@
+#include <sokoban/observation_cache.h>
+
+namespace sokoban {
+
+ObservationCache::ObservationCache(bool compact) : compact(compact) {}
+
+auto ObservationCache::update(const SokobanGameState& state) -> const std::vector<float>& {
+    if (level != state.get_level()) {
+        // New level, full rebuild
+        level = state.get_level();
+        const auto shape = state.observation_shape(compact);
+        obs.resize(static_cast<std::size_t>(shape[0] * shape[1] * shape[2]));
+        state.write_observation(obs.data(), compact);
+    } else {
+        // Only cells whose occupancy changed need to be rewritten
+        BoardBitboard changed = boxes ^ state.get_box_bitboard();
+        changed.set(agent_idx);
+        changed.set(state.get_agent_index());
+        changed.for_each([&](int index) { state.write_observation_cell(obs.data(), index, compact); });
+    }
+    agent_idx = state.get_agent_index();
+    boxes = state.get_box_bitboard();
+    return obs;
+}
+
+auto ObservationCache::get_observation() const noexcept -> const std::vector<float>& {
+    return obs;
+}
+
+}    // namespace sokoban
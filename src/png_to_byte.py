@@ -1,30 +1,51 @@
 import os
-import string
 import subprocess
 
 import cv2
 
 SCRIPT_PATH = os.path.dirname(os.path.abspath(__file__))
 TILES_PATH = os.path.join(os.path.dirname(SCRIPT_PATH), "tiles")
-ASSETS_ALL = os.path.join(SCRIPT_PATH, "assets_all.inc")
+# Output include per tile size, smaller tiles are area-downscaled from the 32x32 tiles
+TILE_SIZES = {
+    32: os.path.join(SCRIPT_PATH, "assets_all.inc"),
+    16: os.path.join(SCRIPT_PATH, "assets_16.inc"),
+    8: os.path.join(SCRIPT_PATH, "assets_8.inc"),
+    1: os.path.join(SCRIPT_PATH, "assets_1.inc"),
+}
 ASSETS_STR = (
     "{0}\n"
     "\n"
-    "const std::unordered_map<VisibleCellType, std::vector<unsigned char>> img_asset_map {{\n"
+    "const std::pair<int, const unsigned char*> img_assets[] = {{\n"
     "{1}"
     "}};\n"
 )
 
+# Cell flags (1 << Element) each tile is drawn for, see src/sprites.cpp
+AGENT, WALL, BOX, GOAL = 0x01, 0x02, 0x04, 0x08
+ASSET_FLAGS = {
+    "empty": 0x00,
+    "wall": WALL,
+    "agent": AGENT,
+    "box": BOX,
+    "agent_goal": AGENT | GOAL,
+    "goal": GOAL,
+    "box_goal": BOX | GOAL,
+}
 
-def main():
-    # asset_headers = ""
+
+def write_assets(tile_size, assets_path):
     asset_mappings = ""
     assets_data = ""
-    for file in os.listdir(TILES_PATH):
+    for file in sorted(os.listdir(TILES_PATH)):
         if file.endswith(".png"):
             img = cv2.cvtColor(
                 cv2.imread("{}/{}".format(TILES_PATH, file)), cv2.COLOR_BGR2RGB
-            ).flatten()
+            )
+            if img.shape[0] != tile_size:
+                img = cv2.resize(
+                    img, (tile_size, tile_size), interpolation=cv2.INTER_AREA
+                )
+            img = img.flatten()
             asset_name = file[:-4]
             binary_file_name = asset_name + ".bin"
             binary_file_path = TILES_PATH + "/" + binary_file_name
@@ -41,26 +62,26 @@ def main():
             )
             stdout = session.stdout.decode("utf-8")
             stdout = stdout.replace("unsigned", "static const unsigned")
-            stdout = stdout.replace(
-                "static const unsigned char {}_bin[]".format(asset_name),
-                "static const std::vector<unsigned char> {}_bin".format(asset_name),
-            )
 
             assets_data += stdout
 
             os.remove(binary_file_path)
 
             # Add to master include list
-            internal_name = "VisibleCellType::k" + string.capwords(
-                asset_name.replace("_", " ")
-            ).replace(" ", "")
-            asset_mappings += "{{ {0}, {1}_bin }},\n".format(internal_name, asset_name)
+            asset_mappings += "{{ 0x{0:02X}, {1}_bin }},\n".format(
+                ASSET_FLAGS[asset_name], asset_name
+            )
 
     # create master include
     print(ASSETS_STR.format(assets_data, asset_mappings))
-    with open(ASSETS_ALL, "w") as f:
+    with open(assets_path, "w") as f:
         f.write(ASSETS_STR.format(assets_data, asset_mappings))
 
 
+def main():
+    for tile_size, assets_path in TILE_SIZES.items():
+        write_assets(tile_size, assets_path)
+
+
 if __name__ == "__main__":
     main()
@@ -0,0 +1,101 @@
+#include <sokoban/push_generator.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace sokoban {
+
+namespace {
+constexpr int kUnreached = -1;
+constexpr int kStartCell = kNumActions;
+}    // namespace
+
+void PushGenerator::generate(const SokobanGameState& state) {
+    FloodFill(state);
+    const auto& level = *state.get_level();
+    const auto& boxes = state.get_box_bitboard();
+    pushes.clear();
+    boxes.for_each([&](int box_cell) {
+        for (int a = 0; a < kNumActions; ++a) {
+            const auto action = static_cast<Action>(a);
+            // Agent needs to reach the cell before the box, and the cell after the box must be free
+            const int agent_cell = level.get_neighbour(box_cell, opposite_action(action));
+            const int box_new_cell = level.get_neighbour(box_cell, action);
+            if (agent_cell != kNoCell && box_new_cell != kNoCell && reachable.test(agent_cell) &&
+                !boxes.test(box_new_cell)) {
+                pushes.push_back({agent_cell, box_cell, action});
+            }
+        }
+    });
+}
+
+void PushGenerator::append_walk(int target_cell, std::vector<Action>& actions) {
+    if (walk_level == nullptr || target_cell < 0 || target_cell >= walk_level->get_flat_size()) {
+        throw std::invalid_argument("Target cell is not reachable");
+    }
+    // Breadth first search restricted to the reachable region, only needed when expanding a solution
+    entered_by.assign(static_cast<std::size_t>(walk_level->get_flat_size()), kUnreached);
+    queue.clear();
+    entered_by[static_cast<std::size_t>(walk_start)] = kStartCell;
+    queue.push_back(walk_start);
+    for (std::size_t i = 0; i < queue.size() && entered_by[static_cast<std::size_t>(target_cell)] == kUnreached;
+         ++i) {
+        for (int a = 0; a < kNumActions; ++a) {
+            const int next = walk_level->get_neighbour(queue[i], static_cast<Action>(a));
+            if (next != kNoCell && reachable.test(next) && entered_by[static_cast<std::size_t>(next)] == kUnreached) {
+                entered_by[static_cast<std::size_t>(next)] = a;
+                queue.push_back(next);
+            }
+        }
+    }
+    if (entered_by[static_cast<std::size_t>(target_cell)] == kUnreached) {
+        throw std::invalid_argument("Target cell is not reachable");
+    }
+    const auto begin = actions.size();
+    for (int cell = target_cell; entered_by[static_cast<std::size_t>(cell)] != kStartCell;) {
+        const auto action = static_cast<Action>(entered_by[static_cast<std::size_t>(cell)]);
+        actions.push_back(action);
+        cell = walk_level->get_neighbour(cell, opposite_action(action));
+    }
+    std::reverse(actions.begin() + static_cast<std::ptrdiff_t>(begin), actions.end());
+}
+
+void PushGenerator::append_push_actions(const PushMove& push, std::vector<Action>& actions) {
+    append_walk(push.agent_cell, actions);
+    actions.push_back(push.direction);
+}
+
+auto PushGenerator::canonical_key(const SokobanGameState& state) -> uint64_t {
+    FloodFill(state);
+    return key;
+}
+
+void PushGenerator::FloodFill(const SokobanGameState& state) {
+    if (walk_level.get() != state.get_level().get()) {
+        walk_level = state.get_level();
+    }
+    walk_start = state.get_agent_index();
+    const auto& level = *walk_level;
+    const auto& boxes = state.get_box_bitboard();
+    // Depth first fill over the neighbour table, visited cells are tracked in the reachable bitboard
+    reachable.clear();
+    reachable.set(state.get_agent_index());
+    queue.clear();
+    queue.push_back(state.get_agent_index());
+    while (!queue.empty()) {
+        const int cell = queue.back();
+        queue.pop_back();
+        for (int a = 0; a < kNumActions; ++a) {
+            const int next = level.get_neighbour(cell, static_cast<Action>(a));
+            if (next != kNoCell && !boxes.test(next) && !reachable.test(next)) {
+                reachable.set(next);
+                queue.push_back(next);
+            }
+        }
+    }
+    const int min_cell = reachable.find_first();
+    key = state.get_hash() ^ level.get_agent_key(state.get_agent_index()) ^ level.get_agent_key(min_cell);
+}
+
+}    // namespace sokoban
@@ -0,0 +1,56 @@
+#include <sokoban/renderer.h>
+
+#include "sprites.h"
+
+namespace sokoban {
+
+Renderer::Renderer(TileSize tile_size, bool grayscale) : tile_size(tile_size), grayscale(grayscale) {}
+
+auto Renderer::render(const SokobanGameState& state) -> const std::vector<uint8_t>& {
+    const auto& atlas = get_sprite_atlas(tile_size, grayscale);
+    const int cols = state.get_level()->get_cols();
+    if (level != state.get_level()) {
+        // New level, draw the background and then the full frame
+        level = state.get_level();
+        const auto shape = state.image_shape(tile_size, grayscale);
+        background.resize(static_cast<std::size_t>(shape[0] * shape[1] * shape[2]));
+        for (int i = 0; i < level->get_flat_size(); ++i) {
+            atlas.blit_sprite(get_sprite_flags(false, level->is_wall(i), false, level->is_goal(i)), background.data(),
+                              cols, i);
+        }
+        image = background;
+        state.get_box_bitboard().for_each(
+            [&](int index) { state.write_image_tile(image.data(), index, tile_size, grayscale); });
+        state.write_image_tile(image.data(), state.get_agent_index(), tile_size, grayscale);
+    } else {
+        // Only tiles whose occupancy changed need to be redrawn, vacated tiles come from the background
+        BoardBitboard changed = boxes ^ state.get_box_bitboard();
+        changed.set(agent_idx);
+        changed.set(state.get_agent_index());
+        const BoardBitboard& new_boxes = state.get_box_bitboard();
+        changed.for_each([&](int index) {
+            if (index == state.get_agent_index() || new_boxes.test(index)) {
+                state.write_image_tile(image.data(), index, tile_size, grayscale);
+            } else {
+                atlas.copy_tile(background.data(), image.data(), cols, index);
+            }
+        });
+    }
+    agent_idx = state.get_agent_index();
+    boxes = state.get_box_bitboard();
+    return image;
+}
+
+auto Renderer::get_image() const noexcept -> const std::vector<uint8_t>& {
+    return image;
+}
+
+auto Renderer::get_tile_size() const noexcept -> TileSize {
+    return tile_size;
+}
+
+auto Renderer::is_grayscale() const noexcept -> bool {
+    return grayscale;
+}
+
+}    // namespace sokoban
@@ -0,0 +1,325 @@
+#include <sokoban/serialization.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+
+#include "mapped_file.h"
+
+namespace sokoban {
+
+namespace {
+constexpr std::array<uint8_t, 4> kStateMagic = {'S', 'K', 'B', 'S'};
+constexpr std::array<uint8_t, 4> kArchiveMagic = {'S', 'K', 'B', 'A'};
+constexpr uint8_t kFlagDeadlockSignal = 1;
+
+// Field offsets, see the format descriptions in the header
+constexpr std::size_t kVersionOffset = 4;
+constexpr std::size_t kFlagsOffset = 5;
+constexpr std::size_t kRowsOffset = 6;
+constexpr std::size_t kColsOffset = 8;
+constexpr std::size_t kAgentOffset = 10;
+constexpr std::size_t kNumBoxesOffset = 12;
+constexpr std::size_t kRewardOffset = 16;
+constexpr std::size_t kHashOffset = 24;
+constexpr std::size_t kStateHeaderSize = 32;
+constexpr std::size_t kCountOffset = 8;
+constexpr std::size_t kArchiveHeaderSize = 16;
+
+// Static cells packed 2 bits each
+constexpr uint8_t kPackedEmpty = 0;
+constexpr uint8_t kPackedWall = 1;
+constexpr uint8_t kPackedGoal = 2;
+constexpr int kCellsPerByte = 4;
+constexpr int kBitsPerByte = 8;
+
+template <typename U>
+void put(std::vector<uint8_t>& out, U value) {
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (kBitsPerByte * i)));
+    }
+}
+
+template <typename U>
+void put(uint8_t* out, U value) noexcept {
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (kBitsPerByte * i));
+    }
+}
+
+template <typename U>
+auto get(const uint8_t* data) noexcept -> U {
+    U value = 0;
+    for (std::size_t i = 0; i < sizeof(U); ++i) {
+        value |= static_cast<U>(static_cast<U>(data[i]) << (kBitsPerByte * i));
+    }
+    return value;
+}
+
+auto static_bytes(int num_cells) noexcept -> std::size_t {
+    return static_cast<std::size_t>((num_cells + kCellsPerByte - 1) / kCellsPerByte);
+}
+
+auto box_bytes(int num_cells) noexcept -> std::size_t {
+    return static_cast<std::size_t>((num_cells + kBitsPerByte - 1) / kBitsPerByte);
+}
+
+auto pack_element(Element el) noexcept -> uint8_t {
+    switch (el) {
+        case Element::kWall:
+            return kPackedWall;
+        case Element::kGoal:
+            return kPackedGoal;
+        default:
+            return kPackedEmpty;
+    }
+}
+
+// Decode and validate a state. A given level is shared by the state instead of building one, it must match the
+// serialized static board.
+auto Deserialize(std::span<const uint8_t> data, const std::shared_ptr<const Level>* level) -> SokobanGameState {
+    if (data.size() < kStateHeaderSize || !std::equal(kStateMagic.begin(), kStateMagic.end(), data.begin())) {
+        throw std::invalid_argument("Not a serialized state");
+    }
+    if (data[kVersionOffset] != kSerializationVersion) {
+        throw std::invalid_argument("Unsupported serialized state version " + std::to_string(data[kVersionOffset]));
+    }
+    SokobanGameState::InternalState s;
+    s.deadlock_signal = (data[kFlagsOffset] & kFlagDeadlockSignal) != 0;
+    s.rows = get<uint16_t>(&data[kRowsOffset]);
+    s.cols = get<uint16_t>(&data[kColsOffset]);
+    s.agent_idx = get<uint16_t>(&data[kAgentOffset]);
+    const int num_boxes = get<uint16_t>(&data[kNumBoxesOffset]);
+    s.reward_signal = get<uint64_t>(&data[kRewardOffset]);
+    s.hash = get<uint64_t>(&data[kHashOffset]);
+
+    const int num_cells = s.rows * s.cols;
+    if (s.rows < 1 || s.cols < 1 || num_cells > kMaxCells) {
+        throw std::invalid_argument("Invalid serialized state dimensions");
+    }
+    if (data.size() != kStateHeaderSize + static_bytes(num_cells) + box_bytes(num_cells)) {
+        throw std::invalid_argument("Serialized state size doesn't match its dimensions");
+    }
+    const uint8_t* packed_static = &data[kStateHeaderSize];
+    const uint8_t* packed_boxes = packed_static + static_bytes(num_cells);
+    if (level != nullptr) {
+        s.level = *level;
+    } else {
+        s.board_static.resize(static_cast<std::size_t>(num_cells));
+        for (int i = 0; i < num_cells; ++i) {
+            const int packed = (packed_static[i / kCellsPerByte] >> (2 * (i % kCellsPerByte))) & 3;
+            if (packed == kPackedWall) {
+                s.board_static[static_cast<std::size_t>(i)] = static_cast<int>(Element::kWall);
+            } else if (packed == kPackedGoal) {
+                s.board_static[static_cast<std::size_t>(i)] = static_cast<int>(Element::kGoal);
+            } else if (packed == kPackedEmpty) {
+                s.board_static[static_cast<std::size_t>(i)] = static_cast<int>(Element::kEmpty);
+            } else {
+                throw std::invalid_argument("Invalid serialized static element");
+            }
+        }
+    }
+    auto is_wall = [&](int i) {
+        return ((packed_static[i / kCellsPerByte] >> (2 * (i % kCellsPerByte))) & 3) == kPackedWall;
+    };
+    s.is_box.resize(static_cast<std::size_t>(num_cells));
+    int box_counter = 0;
+    for (int i = 0; i < num_cells; ++i) {
+        if (((packed_boxes[i / kBitsPerByte] >> (i % kBitsPerByte)) & 1) != 0) {
+            if (is_wall(i)) {
+                throw std::invalid_argument("Serialized box on a wall");
+            }
+            s.is_box[static_cast<std::size_t>(i)] = true;
+            ++box_counter;
+        }
+    }
+    if (box_counter != num_boxes) {
+        throw std::invalid_argument("Serialized box count doesn't match its boxes");
+    }
+    if (s.agent_idx >= num_cells || s.is_box[static_cast<std::size_t>(s.agent_idx)] || is_wall(s.agent_idx)) {
+        throw std::invalid_argument("Invalid serialized agent position");
+    }
+    SokobanGameState state(std::move(s));
+    const auto& state_level = *state.get_level();
+    if (state_level.get_goal_mask().count() != num_boxes) {
+        throw std::invalid_argument("Serialized box count doesn't match the number of goals");
+    }
+    // The stored hash saves nothing but the recomputation, it must agree with the level's keys
+    uint64_t hash = state_level.get_static_hash() ^ state_level.get_agent_key(state.get_agent_index());
+    state.get_box_bitboard().for_each([&](int i) { hash ^= state_level.get_box_key(i); });
+    if (hash != state.get_hash()) {
+        throw std::invalid_argument("Serialized hash doesn't match the state");
+    }
+    return state;
+}
+}    // namespace
+
+auto serialized_size(const SokobanGameState& state) noexcept -> std::size_t {
+    const int num_cells = state.get_level()->get_flat_size();
+    return kStateHeaderSize + static_bytes(num_cells) + box_bytes(num_cells);
+}
+
+void serialize(const SokobanGameState& state, uint8_t* out) noexcept {
+    const auto& level = *state.get_level();
+    const int num_cells = level.get_flat_size();
+    const auto& boxes = state.get_box_bitboard();
+    std::copy(kStateMagic.begin(), kStateMagic.end(), out);
+    out[kVersionOffset] = kSerializationVersion;
+    out[kFlagsOffset] = state.is_deadlock_signal_enabled() ? kFlagDeadlockSignal : 0;
+    put(&out[kRowsOffset], static_cast<uint16_t>(level.get_rows()));
+    put(&out[kColsOffset], static_cast<uint16_t>(level.get_cols()));
+    put(&out[kAgentOffset], static_cast<uint16_t>(state.get_agent_index()));
+    put(&out[kNumBoxesOffset], static_cast<uint16_t>(boxes.count()));
+    put(&out[kNumBoxesOffset + sizeof(uint16_t)], uint16_t{0});
+    put(&out[kRewardOffset], state.get_reward_signal());
+    put(&out[kHashOffset], state.get_hash());
+
+    const auto& board_static = level.get_board_static();
+    uint8_t* packed_static = &out[kStateHeaderSize];
+    std::fill_n(packed_static, static_bytes(num_cells), 0);
+    for (int i = 0; i < num_cells; ++i) {
+        packed_static[i / kCellsPerByte] |=
+            static_cast<uint8_t>(pack_element(board_static[static_cast<std::size_t>(i)]) << (2 * (i % kCellsPerByte)));
+    }
+    uint8_t* packed_boxes = packed_static + static_bytes(num_cells);
+    std::fill_n(packed_boxes, box_bytes(num_cells), 0);
+    boxes.for_each([&](int i) { packed_boxes[i / kBitsPerByte] |= static_cast<uint8_t>(1U << (i % kBitsPerByte)); });
+}
+
+void serialize(const SokobanGameState& state, std::vector<uint8_t>& out) {
+    const std::size_t start = out.size();
+    out.resize(start + serialized_size(state));
+    serialize(state, &out[start]);
+}
+
+auto serialize(const SokobanGameState& state) -> std::vector<uint8_t> {
+    std::vector<uint8_t> out;
+    serialize(state, out);
+    return out;
+}
+
+auto deserialize(std::span<const uint8_t> data) -> SokobanGameState {
+    return Deserialize(data, nullptr);
+}
+
+void serialize_batch(std::span<const SokobanGameState> states, uint8_t* out) {
+    if (states.empty()) {
+        return;
+    }
+    const auto& level = *states.front().get_level();
+    const std::size_t record_size = serialized_size(states.front());
+    for (const auto& state : states) {
+        if (state.get_level()->get_rows() != level.get_rows() || state.get_level()->get_cols() != level.get_cols()) {
+            throw std::invalid_argument("All states in a batch must have the same rows and cols");
+        }
+    }
+    for (const auto& state : states) {
+        serialize(state, out);
+        out += record_size;
+    }
+}
+
+auto deserialize_batch(std::span<const uint8_t> data, std::size_t record_size) -> std::vector<SokobanGameState> {
+    if (record_size < kStateHeaderSize || data.size() % record_size != 0) {
+        throw std::invalid_argument("Invalid record size for the batch");
+    }
+    std::vector<SokobanGameState> states;
+    states.reserve(data.size() / record_size);
+    std::span<const uint8_t> previous;
+    for (std::size_t offset = 0; offset < data.size(); offset += record_size) {
+        const auto record = data.subspan(offset, record_size);
+        // Records of the same dimensions as the previous one have their static board at the same place, and the same
+        // static board means the same level. Levels are shared, so a batch of one level builds it once.
+        const std::shared_ptr<const Level>* level = nullptr;
+        if (!previous.empty() && std::equal(&record[kRowsOffset], &record[kAgentOffset], &previous[kRowsOffset])) {
+            const auto static_end = kStateHeaderSize + static_bytes(states.back().get_level()->get_flat_size());
+            if (std::equal(&record[kStateHeaderSize], &record[static_end], &previous[kStateHeaderSize])) {
+                level = &states.back().get_level();
+            }
+        }
+        states.push_back(Deserialize(record, level));
+        previous = record;
+    }
+    return states;
+}
+
+// ---------------------------------------------------------------------------
+
+void StateArchive::write(const std::string& path, std::span<const SokobanGameState> states) {
+    std::vector<uint8_t> header;
+    header.insert(header.end(), kArchiveMagic.begin(), kArchiveMagic.end());
+    header.push_back(kSerializationVersion);
+    header.resize(kCountOffset, 0);
+    put(header, static_cast<uint64_t>(states.size()));
+    uint64_t offset = 0;
+    put(header, offset);
+    for (const auto& state : states) {
+        offset += serialized_size(state);
+        put(header, offset);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::invalid_argument("Can't open file " + path + " for writing");
+    }
+    file.write(reinterpret_cast<const char*>(header.data()),    // NOLINT(*-reinterpret-cast)
+               static_cast<std::streamsize>(header.size()));
+    std::vector<uint8_t> buffer;
+    for (const auto& state : states) {
+        buffer.clear();
+        serialize(state, buffer);
+        file.write(reinterpret_cast<const char*>(buffer.data()),    // NOLINT(*-reinterpret-cast)
+                   static_cast<std::streamsize>(buffer.size()));
+    }
+    if (!file.flush()) {
+        throw std::invalid_argument("Can't write file " + path);
+    }
+}
+
+StateArchive::StateArchive(const std::string& path) : file(std::make_unique<MappedFile>(path)) {
+    const auto data = file->data();
+    if (data.size() < kArchiveHeaderSize || !std::equal(kArchiveMagic.begin(), kArchiveMagic.end(), data.begin())) {
+        throw std::invalid_argument("Not a state archive: " + path);
+    }
+    if (data[kVersionOffset] != kSerializationVersion) {
+        throw std::invalid_argument("Unsupported state archive version " + std::to_string(data[kVersionOffset]));
+    }
+    const auto count = get<uint64_t>(&data[kCountOffset]);
+    if (count >= (data.size() - kArchiveHeaderSize) / sizeof(uint64_t)) {
+        throw std::invalid_argument("Truncated state archive: " + path);
+    }
+    num_states = static_cast<std::size_t>(count);
+    offsets = &data[kArchiveHeaderSize];
+    states = offsets + ((num_states + 1) * sizeof(uint64_t));
+    states_size = static_cast<std::size_t>(data.data() + data.size() - states);
+    if (get<uint64_t>(offsets + (num_states * sizeof(uint64_t))) > states_size) {
+        throw std::invalid_argument("Truncated state archive: " + path);
+    }
+}
+
+StateArchive::~StateArchive() = default;
+StateArchive::StateArchive(StateArchive&&) noexcept = default;
+auto StateArchive::operator=(StateArchive&&) noexcept -> StateArchive& = default;
+
+auto StateArchive::size() const noexcept -> std::size_t {
+    return num_states;
+}
+
+auto StateArchive::get_bytes(std::size_t index) const -> std::span<const uint8_t> {
+    if (index >= num_states) {
+        throw std::out_of_range("State index out of range");
+    }
+    const auto begin = get<uint64_t>(offsets + (index * sizeof(uint64_t)));
+    const auto end = get<uint64_t>(offsets + ((index + 1) * sizeof(uint64_t)));
+    if (begin > end || end > states_size) {
+        throw std::invalid_argument("Corrupt state archive offsets");
+    }
+    return {states + begin, static_cast<std::size_t>(end - begin)};
+}
+
+auto StateArchive::get_state(std::size_t index) const -> SokobanGameState {
+    return deserialize(get_bytes(index));
+}
+
+}    // namespace sokoban
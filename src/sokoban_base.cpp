@@ -1,55 +1,58 @@
 
 #include <sokoban/sokoban.h>
 
+#include <algorithm>
 #include <cstdint>
-#include <sstream>
 
-namespace sokoban {
+#include "board_parser.h"
+#include "sprites.h"
 
-namespace {
-// https://en.wikipedia.org/wiki/Xorshift
-// Portable RNG Seed
-constexpr uint64_t SPLIT64_S1 = 30;
-constexpr uint64_t SPLIT64_S2 = 27;
-constexpr uint64_t SPLIT64_S3 = 31;
-constexpr uint64_t SPLIT64_C1 = 0x9E3779B97f4A7C15;
-constexpr uint64_t SPLIT64_C2 = 0xBF58476D1CE4E5B9;
-constexpr uint64_t SPLIT64_C3 = 0x94D049BB133111EB;
-auto to_local_hash(int flat_size, Element el, int offset) noexcept -> uint64_t {
-    auto seed = static_cast<uint64_t>((flat_size * static_cast<int>(el)) + offset);
-    uint64_t result = seed + SPLIT64_C1;
-    result = (result ^ (result >> SPLIT64_S1)) * SPLIT64_C2;
-    result = (result ^ (result >> SPLIT64_S2)) * SPLIT64_C3;
-    return result ^ (result >> SPLIT64_S3);
-}
-}    // namespace
+namespace sokoban {
 
 SokobanGameState::SokobanGameState(const std::string& board_str) {
-    std::stringstream board_ss(board_str);
-    std::string segment;
-    std::vector<std::string> seglist;
-    // string split on |
-    while (std::getline(board_ss, segment, '|')) {
-        seglist.push_back(segment);
-    }
+    std::vector<uint8_t> codes;
+    const auto [rows, cols] = parse_board(board_str, codes);
+    Init(rows, cols, codes);
+}
 
-    assert(seglist.size() >= 2);
+SokobanGameState::SokobanGameState(int rows, int cols, std::span<const uint8_t> codes) {
+    Init(rows, cols, codes);
+}
 
-    // Get general info
-    rows = std::stoi(seglist[0]);
-    cols = std::stoi(seglist[1]);
-    if (rows < 1 || cols < 1) {
-        throw std::invalid_argument("rows and/or cols < 1");
+SokobanGameState::SokobanGameState(InternalState&& internal_state)
+    : agent_idx(internal_state.agent_idx),
+      zorb_hash(internal_state.hash),
+      reward_signal(internal_state.reward_signal),
+      deadlock_signal(internal_state.deadlock_signal) {
+    if (internal_state.level) {
+        level = std::move(internal_state.level);
+        if (level->get_rows() != internal_state.rows || level->get_cols() != internal_state.cols) {
+            throw std::invalid_argument("Missmatch in level dimensions");
+        }
+    } else {
+        std::vector<Element> board_static;
+        board_static.reserve(internal_state.board_static.size());
+        for (const auto& el : internal_state.board_static) {
+            board_static.push_back(static_cast<Element>(el));
+        }
+        level = std::make_shared<const Level>(internal_state.rows, internal_state.cols, std::move(board_static));
+    }
+    if (internal_state.is_box.size() != static_cast<std::size_t>(level->get_flat_size())) {
+        throw std::invalid_argument("Missmatch in box elements");
     }
+    for (int i = 0; i < level->get_flat_size(); ++i) {
+        boxes.set(i, internal_state.is_box[static_cast<std::size_t>(i)]);
+    }
+}
 
-    assert(static_cast<int>(seglist.size()) == rows * cols + 2);
+void SokobanGameState::Init(int rows, int cols, std::span<const uint8_t> codes) {
+    validate_board(rows, cols, codes);
 
     // Parse grid
-    int agent_counter = 0;
-    int box_counter = 0;
-    int goal_counter = 0;
-    for (std::size_t i = 2; i < seglist.size(); ++i) {
-        const auto el_idx = std::stoi(seglist[i]);
+    std::vector<Element> board_static;
+    board_static.reserve(codes.size());
+    std::vector<int> box_indices;
+    for (std::size_t i = 0; i < codes.size(); ++i) {
         // 0 Agent
         // 1 Wall
         // 2 Box
@@ -57,108 +60,48 @@ SokobanGameState::SokobanGameState(const std::string& board_str) {
         // 4 Empty
         // 5 Agent Goal
         // 6 Box Goal
-        if (el_idx >= kNumElements) {
-            std::stringstream s;
-            s << "Unknown element type: " << el_idx;
-            throw std::invalid_argument(s.str());
-        }
-
-        {
-            switch (el_idx) {
-                case 0:    // Agent
-                    agent_idx = static_cast<int>(i) - 2;
-                    board_static.push_back(Element::kEmpty);
-                    is_box.push_back(false);
-                    ++agent_counter;
-                    break;
-                case 1:    // Wall
-                    board_static.push_back(Element::kWall);
-                    is_box.push_back(false);
-                    break;
-                case 2:    // Box
-                    is_box.push_back(true);
-                    board_static.push_back(Element::kEmpty);
-                    ++box_counter;
-                    break;
-                case 3:    // Goal
-                    ++goal_counter;
-                    is_box.push_back(false);
-                    board_static.push_back(Element::kGoal);
-                    break;
-                case 4:    // Empty
-                    is_box.push_back(false);
-                    board_static.push_back(Element::kEmpty);
-                    break;
-                case 5:    // Agent on goal
-                    agent_idx = static_cast<int>(i) - 2;
-                    is_box.push_back(false);
-                    board_static.push_back(Element::kGoal);
-                    ++goal_counter;
-                    ++agent_counter;
-                    break;
-                case 6:    // Box on goal
-                    is_box.push_back(true);
-                    board_static.push_back(Element::kGoal);
-                    ++box_counter;
-                    ++goal_counter;
-                    break;
-            }
+        switch (codes[i]) {
+            case 0:    // Agent
+                agent_idx = static_cast<int>(i);
+                board_static.push_back(Element::kEmpty);
+                break;
+            case 1:    // Wall
+                board_static.push_back(Element::kWall);
+                break;
+            case 2:    // Box
+                box_indices.push_back(static_cast<int>(i));
+                board_static.push_back(Element::kEmpty);
+                break;
+            case 3:    // Goal
+                board_static.push_back(Element::kGoal);
+                break;
+            case 4:    // Empty
+                board_static.push_back(Element::kEmpty);
+                break;
+            case 5:    // Agent on goal
+                agent_idx = static_cast<int>(i);
+                board_static.push_back(Element::kGoal);
+                break;
+            case 6:    // Box on goal
+                box_indices.push_back(static_cast<int>(i));
+                board_static.push_back(Element::kGoal);
+                break;
         }
     }
+    level = std::make_shared<const Level>(rows, cols, std::move(board_static));
 
-    if (board_static.size() != static_cast<std::size_t>(rows * cols)) {
-        throw std::invalid_argument("Missmatch in board elements");
-    }
-    if (box_counter != goal_counter) {
-        throw std::invalid_argument("Missmatch in number of boxes and goals");
-    }
-
-    if (agent_counter == 0) {
-        throw std::invalid_argument("Agent element not found");
-    } else if (agent_counter > 1) {
-        throw std::invalid_argument("Too many agent elements, expected only one");
-    }
-
-    // Init hash
-    int flat_size = rows * cols;
-    zorb_hash = 0;
-    // Static board
-    {
-        int i = -1;
-        for (const auto& el : board_static) {
-            zorb_hash ^= to_local_hash(flat_size, el, ++i);
-        }
-    }
+    // Init hash, static board contribution is shared by the level
+    zorb_hash = level->get_static_hash();
     // Dynamic elements
-    zorb_hash ^= to_local_hash(flat_size, Element::kAgent, agent_idx);
-    {
-        int i = -1;
-        for (const auto b : is_box) {
-            ++i;
-            if (b) {
-                zorb_hash ^= to_local_hash(flat_size, Element::kBox, i);
-            }
-        }
-    }
-}
-
-SokobanGameState::SokobanGameState(InternalState&& internal_state)
-    : rows(internal_state.rows),
-      cols(internal_state.cols),
-      agent_idx(internal_state.agent_idx),
-      zorb_hash(internal_state.hash),
-      reward_signal(internal_state.reward_signal),
-      is_box(std::move(internal_state).is_box) {
-    board_static.clear();
-    board_static.reserve(internal_state.board_static.size());
-    for (const auto& el : internal_state.board_static) {
-        board_static.push_back(static_cast<Element>(el));
+    zorb_hash ^= level->get_agent_key(agent_idx);
+    for (const auto& i : box_indices) {
+        boxes.set(i);
+        zorb_hash ^= level->get_box_key(i);
     }
 }
 
 auto SokobanGameState::operator==(const SokobanGameState& other) const noexcept -> bool {
-    return rows == other.rows && cols == other.cols && agent_idx == other.agent_idx &&
-           board_static == other.board_static && is_box == other.is_box;
+    return agent_idx == other.agent_idx && boxes == other.boxes && *level == *other.level;
 }
 
 auto SokobanGameState::operator!=(const SokobanGameState& other) const noexcept -> bool {
@@ -171,38 +114,111 @@ void SokobanGameState::apply_action(Action action) {
     assert(is_valid_action(action));
 
     reward_signal = 0;
-    // If action results not in bounds, don't do anything
-    if (!InBounds(agent_idx, action)) {
+    // Neighbour is kNoCell if the action results not in bounds or into a wall, don't do anything
+    const auto new_index = level->get_neighbour(agent_idx, action);
+    if (new_index == kNoCell) {
         return;
     }
-    const auto new_index = IndexFromAction(agent_idx, action);
-    // Move agent if not wall and not box (i.e. empty or over an unoccupied goal)
-    if (IsTraversible(agent_idx, action)) {
-        MoveAgent(action);
-        agent_idx = new_index;
-    } else if (IsPushable(agent_idx, action)) {
-        Push(agent_idx, action);
-        agent_idx = new_index;
+    // Move agent if not box (i.e. empty or over an unoccupied goal)
+    if (!boxes.test(new_index)) {
+        MoveAgent(new_index);
+        return;
+    }
+    // Otherwise push box if 1 past box in same direction is free
+    const auto box_new_index = level->get_neighbour(new_index, action);
+    if (box_new_index != kNoCell && !boxes.test(box_new_index)) {
+        MoveBox(new_index, box_new_index);
+        MoveAgent(new_index);
+    }
+}
+
+void SokobanGameState::apply_push(int agent_cell, Action action) {
+    MoveAgent(agent_cell);
+    apply_action(action);
+}
+
+auto SokobanGameState::apply_action_undoable(Action action) -> UndoRecord {
+    UndoRecord undo{.agent_index = agent_idx, .box_from = kNoCell, .box_to = kNoCell, .reward_signal = reward_signal};
+    const auto new_index = level->get_neighbour(agent_idx, action);
+    if (new_index != kNoCell && boxes.test(new_index)) {
+        const auto box_new_index = level->get_neighbour(new_index, action);
+        if (box_new_index != kNoCell && !boxes.test(box_new_index)) {
+            undo.box_from = new_index;
+            undo.box_to = box_new_index;
+        }
+    }
+    apply_action(action);
+    return undo;
+}
+
+auto SokobanGameState::apply_push_undoable(int agent_cell, Action action) -> UndoRecord {
+    const int agent_before = agent_idx;
+    MoveAgent(agent_cell);
+    UndoRecord undo = apply_action_undoable(action);
+    undo.agent_index = agent_before;
+    return undo;
+}
+
+void SokobanGameState::undo_action(const UndoRecord& undo) noexcept {
+    if (undo.box_from != kNoCell) {
+        zorb_hash ^= level->get_box_key(undo.box_to) ^ level->get_box_key(undo.box_from);
+        boxes.reset(undo.box_to);
+        boxes.set(undo.box_from);
     }
+    MoveAgent(undo.agent_index);
+    reward_signal = undo.reward_signal;
+}
+
+auto SokobanGameState::legal_action_mask() const noexcept -> uint8_t {
+    return ActionMasks().first;
+}
+
+auto SokobanGameState::push_action_mask() const noexcept -> uint8_t {
+    return ActionMasks().second;
 }
 
 auto SokobanGameState::is_solution() const noexcept -> bool {
     // Every box lies on a goal tile
-    for (std::size_t i = 0; i < static_cast<std::size_t>(rows * cols); ++i) {
-        if (!is_box[i] && board_static[i] == Element::kGoal) {
-            return false;
-        }
+    return level->get_goal_mask().is_subset_of(boxes);
+}
+
+auto SokobanGameState::is_deadlocked() const noexcept -> bool {
+    // Boxes off goal on dead squares, goals are never dead
+    if ((boxes & level->get_dead_mask()).any()) {
+        return true;
     }
-    return true;
+    bool deadlocked = false;
+    boxes.for_each([&](int box_index) {
+        deadlocked = deadlocked || (!level->is_goal(box_index) && is_box_deadlocked(box_index));
+    });
+    return deadlocked;
+}
+
+auto SokobanGameState::is_box_deadlocked(int box_index) const noexcept -> bool {
+    if (level->is_dead_square(box_index)) {
+        return true;
+    }
+    BoardBitboard blocking;
+    const auto [frozen, off_goal] = FreezeCheck(box_index, blocking);
+    return frozen && off_goal;
+}
+
+void SokobanGameState::set_deadlock_signal(bool enabled) noexcept {
+    deadlock_signal = enabled;
+}
+
+auto SokobanGameState::is_deadlock_signal_enabled() const noexcept -> bool {
+    return deadlock_signal;
 }
 
 auto SokobanGameState::observation_shape(bool compact) const noexcept -> std::array<int, 3> {
     // Empty doesn't get a channel, empty = all channels 0
-    return {compact ? kNumChannelsCompact : kNumChannels, cols, rows};
+    return {compact ? kNumChannelsCompact : kNumChannels, level->get_cols(), level->get_rows()};
 }
 
-void SokobanGameState::_get_observation_non_compact(std::vector<float>& obs) const noexcept {
-    const auto channel_size = static_cast<std::size_t>(rows * cols);
+template <typename T>
+void SokobanGameState::_get_observation_non_compact(T* obs) const noexcept {
+    const auto channel_size = static_cast<std::size_t>(level->get_flat_size());
 
     // Set empty channel
     for (std::size_t i = 0; i < channel_size; ++i) {
@@ -211,7 +227,7 @@ void SokobanGameState::_get_observation_non_compact(std::vector<float>& obs) con
 
     // Set wall and goal (remove empty from these cells)
     std::size_t i = 0;
-    for (const auto& el : board_static) {
+    for (const auto& el : level->get_board_static()) {
         if (el == Element::kWall || el == Element::kGoal) {
             obs[(static_cast<std::size_t>(el) * channel_size) + i] = 1;
             obs[(static_cast<std::size_t>(Element::kEmpty) * channel_size) + i] = 0;
@@ -227,10 +243,8 @@ void SokobanGameState::_get_observation_non_compact(std::vector<float>& obs) con
     obs[(static_cast<std::size_t>(Element::kEmpty) * channel_size) + static_cast<std::size_t>(agent_idx)] = 0;
 
     // Set boxes
-    for (std::size_t box_idx = 0; box_idx < channel_size; ++box_idx) {
-        if (!is_box[static_cast<std::size_t>(box_idx)]) {
-            continue;
-        }
+    boxes.for_each([&](int box_i) {
+        const auto box_idx = static_cast<std::size_t>(box_i);
         bool box_on_goal = obs[(static_cast<std::size_t>(Element::kGoal) * channel_size) + box_idx] == 1;
         // Box channel is either box + goal or just box
         std::size_t box_channel = box_on_goal ? ChannelBoxOnGoal : static_cast<std::size_t>(Element::kBox);
@@ -242,15 +256,16 @@ void SokobanGameState::_get_observation_non_compact(std::vector<float>& obs) con
         std::size_t goal_channel =
             box_on_goal ? static_cast<std::size_t>(Element::kGoal) : static_cast<std::size_t>(Element::kEmpty);
         obs[(goal_channel * channel_size) + box_idx] = 0;
-    }
+    });
 }
 
-void SokobanGameState::_get_observation_compact(std::vector<float>& obs) const noexcept {
-    const auto channel_size = static_cast<std::size_t>(rows * cols);
+template <typename T>
+void SokobanGameState::_get_observation_compact(T* obs) const noexcept {
+    const auto channel_size = static_cast<std::size_t>(level->get_flat_size());
 
     // Set wall and goal
     std::size_t i = 0;
-    for (const auto& el : board_static) {
+    for (const auto& el : level->get_board_static()) {
         if (el == Element::kWall || el == Element::kGoal) {
             obs[(static_cast<std::size_t>(el) * channel_size) + i] = 1;
         }
@@ -258,61 +273,195 @@ void SokobanGameState::_get_observation_compact(std::vector<float>& obs) const n
     }
     // Set agent and boxes
     obs[(static_cast<std::size_t>(Element::kAgent) * channel_size) + static_cast<std::size_t>(agent_idx)] = 1;
-    for (std::size_t box_idx = 0; box_idx < channel_size; ++box_idx) {
-        if (!is_box[static_cast<std::size_t>(box_idx)]) {
-            continue;
+    boxes.for_each([&](int box_idx) {
+        obs[(static_cast<std::size_t>(Element::kBox) * channel_size) + static_cast<std::size_t>(box_idx)] = 1;
+    });
+}
+
+void SokobanGameState::_get_observation_cell_code(uint8_t* obs) const noexcept {
+    for (int i = 0; i < level->get_flat_size(); ++i) {
+        const bool on_goal = level->is_goal(i);
+        CellCode code = on_goal ? CellCode::kGoal : CellCode::kEmpty;
+        if (i == agent_idx) {
+            code = on_goal ? CellCode::kAgentOnGoal : CellCode::kAgent;
+        } else if (boxes.test(i)) {
+            code = on_goal ? CellCode::kBoxOnGoal : CellCode::kBox;
+        } else if (level->is_wall(i)) {
+            code = CellCode::kWall;
         }
-        obs[(static_cast<std::size_t>(Element::kBox) * channel_size) + box_idx] = 1;
+        obs[static_cast<std::size_t>(i)] = static_cast<uint8_t>(code);
+    }
+}
+
+namespace {
+// Pack the first flat_size bits of a bitboard, 8 cells per byte with the lowest cell in the lowest bit
+void pack_bits(const BoardBitboard& bits, int flat_size, uint8_t* out) noexcept {
+    const auto& words = bits.get_words();
+    const auto num_bytes = static_cast<std::size_t>((flat_size + 7) / 8);
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+        out[i] = static_cast<uint8_t>(words[i / 8] >> ((i % 8) * 8));
+    }
+    if (flat_size % 8 != 0) {
+        out[num_bytes - 1] &= static_cast<uint8_t>((1U << static_cast<unsigned int>(flat_size % 8)) - 1);
+    }
+}
+}    // namespace
+
+void SokobanGameState::_get_observation_bit_packed(uint8_t* obs, bool compact) const noexcept {
+    const int flat_size = level->get_flat_size();
+    const auto plane_size = static_cast<std::size_t>((flat_size + 7) / 8);
+    const auto& walls = level->get_wall_mask();
+    const auto& goals = level->get_goal_mask();
+    BoardBitboard agent;
+    agent.set(agent_idx);
+    const auto write_plane = [&](int channel, const BoardBitboard& bits) {
+        pack_bits(bits, flat_size, obs + (static_cast<std::size_t>(channel) * plane_size));
+    };
+
+    // Same channel rules as the one-hot representations
+    if (compact) {
+        write_plane(static_cast<int>(Element::kAgent), agent);
+        write_plane(static_cast<int>(Element::kWall), walls);
+        write_plane(static_cast<int>(Element::kBox), boxes);
+        write_plane(static_cast<int>(Element::kGoal), goals);
+        return;
     }
+    write_plane(static_cast<int>(Element::kAgent), agent & ~goals);
+    write_plane(static_cast<int>(Element::kWall), walls);
+    write_plane(static_cast<int>(Element::kBox), boxes & ~goals);
+    write_plane(static_cast<int>(Element::kGoal), goals & ~boxes);
+    write_plane(static_cast<int>(Element::kEmpty), level->get_board_mask() & ~(walls | goals | agent | boxes));
+    write_plane(ChannelAgentOnGoal, agent & goals);
+    write_plane(ChannelBoxOnGoal, boxes & goals);
+}
+
+auto SokobanGameState::observation_shape(ObservationFormat format, bool compact) const noexcept
+    -> std::array<int, 3> {
+    const int num_channels = compact ? kNumChannelsCompact : kNumChannels;
+    switch (format) {
+        case ObservationFormat::kCellCode:
+            return {1, level->get_cols(), level->get_rows()};
+        case ObservationFormat::kBitPacked:
+            return {num_channels, 1, (level->get_flat_size() + 7) / 8};
+        default:
+            return observation_shape(compact);
+    }
+}
+
+auto SokobanGameState::observation_size(ObservationFormat format, bool compact) const noexcept -> std::size_t {
+    const auto shape = observation_shape(format, compact);
+    return static_cast<std::size_t>(shape[0] * shape[1] * shape[2]);
 }
 
 auto SokobanGameState::get_observation(bool compact) const noexcept -> std::vector<float> {
-    const auto channel_size = static_cast<std::size_t>(rows * cols);
-    std::vector<float> obs(static_cast<std::size_t>(compact ? kNumChannelsCompact : kNumChannels) * channel_size, 0);
+    const auto channel_size = static_cast<std::size_t>(level->get_flat_size());
+    std::vector<float> obs(static_cast<std::size_t>(compact ? kNumChannelsCompact : kNumChannels) * channel_size);
+    write_observation(obs.data(), compact);
+    return obs;
+}
+
+void SokobanGameState::write_observation(float* out, bool compact) const noexcept {
+    const auto channel_size = static_cast<std::size_t>(level->get_flat_size());
+    std::fill_n(out, static_cast<std::size_t>(compact ? kNumChannelsCompact : kNumChannels) * channel_size, 0.0F);
     if (compact) {
-        _get_observation_compact(obs);
+        _get_observation_compact(out);
     } else {
-        _get_observation_non_compact(obs);
+        _get_observation_non_compact(out);
     }
-    return obs;
 }
 
-// Binary image data
-#include "assets_all.inc"
+void SokobanGameState::write_observation_cell(float* out, int index, bool compact) const noexcept {
+    const auto channel_size = static_cast<std::size_t>(level->get_flat_size());
+    const auto idx = static_cast<std::size_t>(index);
+    const int num_channels = compact ? kNumChannelsCompact : kNumChannels;
+    for (int c = 0; c < num_channels; ++c) {
+        out[(static_cast<std::size_t>(c) * channel_size) + idx] = 0;
+    }
+
+    const auto el = level->get_element(index);
+    const bool is_agent = index == agent_idx;
+    const bool is_box = boxes.test(index);
+    if (el == Element::kWall || el == Element::kGoal) {
+        out[(static_cast<std::size_t>(el) * channel_size) + idx] = 1;
+    }
+    if (compact) {
+        if (is_agent) {
+            out[(static_cast<std::size_t>(Element::kAgent) * channel_size) + idx] = 1;
+        }
+        if (is_box) {
+            out[(static_cast<std::size_t>(Element::kBox) * channel_size) + idx] = 1;
+        }
+        return;
+    }
+
+    // Same rules as the full non-compact observation
+    const bool on_goal = el == Element::kGoal;
+    const bool is_empty = el != Element::kWall && !on_goal && !is_agent && !is_box;
+    out[(static_cast<std::size_t>(Element::kEmpty) * channel_size) + idx] = is_empty ? 1 : 0;
+    if (is_agent) {
+        const std::size_t agent_channel = on_goal ? ChannelAgentOnGoal : static_cast<std::size_t>(Element::kAgent);
+        out[(agent_channel * channel_size) + idx] = 1;
+    }
+    if (is_box) {
+        const std::size_t box_channel = on_goal ? ChannelBoxOnGoal : static_cast<std::size_t>(Element::kBox);
+        out[(box_channel * channel_size) + idx] = 1;
+        out[(static_cast<std::size_t>(Element::kGoal) * channel_size) + idx] = 0;
+    }
+}
 
-auto SokobanGameState::image_shape() const noexcept -> std::array<int, 3> {
-    return {rows * SPRITE_HEIGHT, cols * SPRITE_WIDTH, SPRITE_CHANNELS};
+auto SokobanGameState::get_observation_bytes(ObservationFormat format, bool compact) const -> std::vector<uint8_t> {
+    std::vector<uint8_t> obs(observation_size(format, compact));
+    write_observation(obs.data(), format, compact);
+    return obs;
 }
 
-auto SokobanGameState::to_image() const noexcept -> std::vector<uint8_t> {
-    const auto flat_size = static_cast<std::size_t>(rows * cols);
-    std::vector<uint8_t> img(flat_size * SPRITE_DATA_LEN, 0);
-    for (int h = 0; h < rows; ++h) {
-        for (int w = 0; w < cols; ++w) {
-            const auto img_idx_top_left =
-                static_cast<std::size_t>(h * (SPRITE_DATA_LEN * cols) + (w * SPRITE_DATA_LEN_PER_ROW));
-            const auto idx = static_cast<std::size_t>(h * cols + w);
-            int flags = 0;
-            flags |= static_cast<std::size_t>(agent_idx) == idx ? 1 << static_cast<int>(Element::kAgent) : 0;
-            flags |= board_static.at(idx) == Element::kWall ? 1 << static_cast<int>(Element::kWall) : 0;
-            flags |= board_static.at(idx) == Element::kGoal ? 1 << static_cast<int>(Element::kGoal) : 0;
-            flags |= is_box[static_cast<std::size_t>(idx)] ? 1 << static_cast<int>(Element::kBox) : 0;
-            const std::vector<uint8_t>& data = img_asset_map.at(flags);
-            for (std::size_t r = 0; r < SPRITE_HEIGHT; ++r) {
-                for (std::size_t c = 0; c < SPRITE_WIDTH; ++c) {
-                    const std::size_t data_idx = (r * SPRITE_DATA_LEN_PER_ROW) + (3 * c);
-                    const std::size_t img_idx = (r * SPRITE_DATA_LEN_PER_ROW * static_cast<std::size_t>(cols)) +
-                                                (SPRITE_CHANNELS * c) + img_idx_top_left;
-                    img[img_idx + 0] = data[data_idx + 0];
-                    img[img_idx + 1] = data[data_idx + 1];
-                    img[img_idx + 2] = data[data_idx + 2];
-                }
+void SokobanGameState::write_observation(uint8_t* out, ObservationFormat format, bool compact) const {
+    switch (format) {
+        case ObservationFormat::kUint8:
+            std::fill_n(out, observation_size(format, compact), uint8_t{0});
+            if (compact) {
+                _get_observation_compact(out);
+            } else {
+                _get_observation_non_compact(out);
             }
-        }
+            break;
+        case ObservationFormat::kCellCode:
+            _get_observation_cell_code(out);
+            break;
+        case ObservationFormat::kBitPacked:
+            _get_observation_bit_packed(out, compact);
+            break;
+        default:
+            throw std::invalid_argument("Byte observations can't use ObservationFormat::kFloat");
     }
+}
+
+auto SokobanGameState::image_shape(TileSize tile_size, bool grayscale) const noexcept -> std::array<int, 3> {
+    const int tile_pixels = static_cast<int>(tile_size);
+    return {level->get_rows() * tile_pixels, level->get_cols() * tile_pixels, grayscale ? 1 : SPRITE_CHANNELS};
+}
+
+auto SokobanGameState::to_image(TileSize tile_size, bool grayscale) const -> std::vector<uint8_t> {
+    const auto shape = image_shape(tile_size, grayscale);
+    std::vector<uint8_t> img(static_cast<std::size_t>(shape[0] * shape[1] * shape[2]));
+    write_image(img.data(), tile_size, grayscale);
     return img;
 }
 
+void SokobanGameState::write_image(uint8_t* out, TileSize tile_size, bool grayscale) const {
+    const auto& atlas = get_sprite_atlas(tile_size, grayscale);
+    for (int i = 0; i < level->get_flat_size(); ++i) {
+        const int flags = get_sprite_flags(i == agent_idx, level->is_wall(i), boxes.test(i), level->is_goal(i));
+        atlas.blit_sprite(flags, out, level->get_cols(), i);
+    }
+}
+
+void SokobanGameState::write_image_tile(uint8_t* out, int index, TileSize tile_size, bool grayscale) const {
+    const int flags =
+        get_sprite_flags(index == agent_idx, level->is_wall(index), boxes.test(index), level->is_goal(index));
+    get_sprite_atlas(tile_size, grayscale).blit_sprite(flags, out, level->get_cols(), index);
+}
+
 auto SokobanGameState::get_reward_signal() const noexcept -> uint64_t {
     return reward_signal;
 }
@@ -323,18 +472,15 @@ auto SokobanGameState::get_hash() const noexcept -> uint64_t {
 
 auto SokobanGameState::get_box_indices() const noexcept -> std::vector<int> {
     std::vector<int> indices;
-    for (int i = 0; i < rows * cols; ++i) {
-        if (is_box[static_cast<std::size_t>(i)]) {
-            indices.push_back(i);
-        }
-    }
+    indices.reserve(static_cast<std::size_t>(boxes.count()));
+    boxes.for_each([&](int i) { indices.push_back(i); });
     return indices;
 }
 
 auto SokobanGameState::get_empty_goal_indices() const noexcept -> std::vector<int> {
     std::vector<int> indices;
-    for (int i = 0; i < rows * cols; ++i) {
-        if (!is_box[static_cast<std::size_t>(i)] && board_static[static_cast<std::size_t>(i)] == Element::kGoal) {
+    for (const auto& i : level->get_goal_indices()) {
+        if (!boxes.test(i)) {
             indices.push_back(i);
         }
     }
@@ -343,8 +489,8 @@ auto SokobanGameState::get_empty_goal_indices() const noexcept -> std::vector<in
 
 auto SokobanGameState::get_solved_goal_indices() const noexcept -> std::vector<int> {
     std::vector<int> indices;
-    for (int i = 0; i < rows * cols; ++i) {
-        if (is_box[static_cast<std::size_t>(i)] && board_static[static_cast<std::size_t>(i)] == Element::kGoal) {
+    for (const auto& i : level->get_goal_indices()) {
+        if (boxes.test(i)) {
             indices.push_back(i);
         }
     }
@@ -352,36 +498,41 @@ auto SokobanGameState::get_solved_goal_indices() const noexcept -> std::vector<i
 }
 
 auto SokobanGameState::get_all_goal_indices() const noexcept -> std::vector<int> {
-    std::vector<int> indices;
-    for (int i = 0; i < rows * cols; ++i) {
-        if (board_static[static_cast<std::size_t>(i)] == Element::kGoal) {
-            indices.push_back(i);
-        }
-    }
-    return indices;
+    return level->get_goal_indices();
 }
 
 auto SokobanGameState::get_agent_index() const noexcept -> int {
     return agent_idx;
 }
 
+auto SokobanGameState::get_box_bitboard() const noexcept -> const BoardBitboard& {
+    return boxes;
+}
+
+auto SokobanGameState::get_level() const noexcept -> const std::shared_ptr<const Level>& {
+    return level;
+}
+
 auto operator<<(std::ostream& os, const SokobanGameState& state) -> std::ostream& {
+    const int rows = state.level->get_rows();
+    const int cols = state.level->get_cols();
+    const auto& board_static = state.level->get_board_static();
     const auto print_horz_boarder = [&]() {
-        for (int w = 0; w < state.cols + 2; ++w) {
+        for (int w = 0; w < cols + 2; ++w) {
             os << "-";
         }
         os << std::endl;
     };
     print_horz_boarder();
-    for (int h = 0; h < state.rows; ++h) {
+    for (int h = 0; h < rows; ++h) {
         os << "|";
-        for (int w = 0; w < state.cols; ++w) {
-            const auto idx = static_cast<std::size_t>(h * state.cols + w);
+        for (int w = 0; w < cols; ++w) {
+            const auto idx = static_cast<std::size_t>(h * cols + w);
             int mask = 0;
             mask |= idx == static_cast<std::size_t>(state.agent_idx) ? 1 << static_cast<int>(Element::kAgent) : 0;
-            mask |= state.board_static.at(idx) == Element::kWall ? 1 << static_cast<int>(Element::kWall) : 0;
-            mask |= state.board_static.at(idx) == Element::kGoal ? 1 << static_cast<int>(Element::kGoal) : 0;
-            mask |= state.is_box[static_cast<std::size_t>(idx)] ? 1 << static_cast<int>(Element::kBox) : 0;
+            mask |= board_static.at(idx) == Element::kWall ? 1 << static_cast<int>(Element::kWall) : 0;
+            mask |= board_static.at(idx) == Element::kGoal ? 1 << static_cast<int>(Element::kGoal) : 0;
+            mask |= state.boxes.test(static_cast<int>(idx)) ? 1 << static_cast<int>(Element::kBox) : 0;
             os << kElementToStr.at(mask);
         }
         os << "|" << std::endl;
@@ -393,76 +544,94 @@ auto operator<<(std::ostream& os, const SokobanGameState& state) -> std::ostream
 
 // ---------------------------------------------------------------------------
 
-auto SokobanGameState::IndexFromAction(int index, Action action) const noexcept -> int {
-    auto col = index % cols;
-    auto row = (index - col) / cols;
-    const auto& offsets = kActionOffsets[static_cast<std::size_t>(action)];    // NOLINT(*-array-index)
-    col += offsets.first;
-    row += offsets.second;
-    return (cols * row) + col;
-}
-
-auto SokobanGameState::InBounds(int index, Action action) const noexcept -> bool {
-    int col = index % cols;
-    int row = (index - col) / cols;
-    const auto& offsets = kActionOffsets[static_cast<std::size_t>(action)];    // NOLINT(*-array-index)
-    col += offsets.first;
-    row += offsets.second;
-    return col >= 0 && col < static_cast<int>(cols) && row >= 0 && row < static_cast<int>(rows);
-}
-
-void SokobanGameState::MoveAgent(Action action) noexcept {
-    const auto flat_size = rows * cols;
-    zorb_hash ^= to_local_hash(flat_size, Element::kAgent, agent_idx);
-    agent_idx = IndexFromAction(agent_idx, action);
-    zorb_hash ^= to_local_hash(flat_size, Element::kAgent, agent_idx);
+void SokobanGameState::MoveAgent(int new_index) noexcept {
+    zorb_hash ^= level->get_agent_key(agent_idx);
+    agent_idx = new_index;
+    zorb_hash ^= level->get_agent_key(agent_idx);
 }
 
-void SokobanGameState::MoveBox(int box_index, Action action) noexcept {
-    const auto flat_size = rows * cols;
-    zorb_hash ^= to_local_hash(flat_size, Element::kBox, box_index);
-    is_box[static_cast<std::size_t>(box_index)] = false;
+void SokobanGameState::MoveBox(int box_index, int box_new_index) noexcept {
+    zorb_hash ^= level->get_box_key(box_index);
+    boxes.reset(box_index);
 
     // Move box
-    const auto box_new_index = IndexFromAction(box_index, action);
-    zorb_hash ^= to_local_hash(flat_size, Element::kBox, box_new_index);
-    is_box[static_cast<std::size_t>(box_new_index)] = true;
+    zorb_hash ^= level->get_box_key(box_new_index);
+    boxes.set(box_new_index);
 
     // Check if on goal
-    const bool box_on_goal = board_static.at(static_cast<std::size_t>(box_new_index)) == Element::kGoal;
+    const bool box_on_goal = level->is_goal(box_new_index);
     reward_signal = box_on_goal ? 1 : 0;
-}
-
-auto SokobanGameState::IsTraversible(int index, Action action) const noexcept -> bool {
-    if (!InBounds(index, action)) {
-        return false;
+    if (deadlock_signal && is_box_deadlocked(box_new_index)) {
+        reward_signal |= kRewardDeadlock;
     }
-    const auto new_index = static_cast<std::size_t>(IndexFromAction(index, action));
-    // new_index isn't box and isn't wall
-    return !is_box[new_index] && board_static.at(new_index) != Element::kWall;
 }
 
-auto SokobanGameState::IsPushable(int index, Action action) const noexcept -> bool {
-    if (!InBounds(index, action)) {
-        return false;
-    }
-    const auto box_index = IndexFromAction(index, action);
-
-    // No box at the query index
-    if (!is_box[static_cast<std::size_t>(box_index)]) {
-        return false;
+// Same rules as apply_action(), legal moves in the first mask and the pushes among them in the second
+auto SokobanGameState::ActionMasks() const noexcept -> std::pair<uint8_t, uint8_t> {
+    uint8_t legal = 0;
+    uint8_t push = 0;
+    for (int a = 0; a < kNumActions; ++a) {
+        const auto action = static_cast<Action>(a);
+        const auto bit = static_cast<uint8_t>(1U << static_cast<unsigned>(a));
+        const auto new_index = level->get_neighbour(agent_idx, action);
+        if (new_index == kNoCell) {
+            continue;
+        }
+        if (!boxes.test(new_index)) {
+            legal |= bit;
+            continue;
+        }
+        const auto box_new_index = level->get_neighbour(new_index, action);
+        if (box_new_index != kNoCell && !boxes.test(box_new_index)) {
+            legal |= bit;
+            push |= bit;
+        }
     }
-
-    // Check 1 past box in same direction
-    return IsTraversible(box_index, action);
+    return {legal, push};
 }
 
-void SokobanGameState::Push(int index, Action action) noexcept {
-    const auto box_index = IndexFromAction(index, action);
-    MoveBox(box_index, action);
-    MoveAgent(action);
+// Returns whether the box can't move along either axis, and whether it or any box it depends on is off goal.
+// Boxes in the blocking set are treated as walls while their own check is in progress, so mutually blocking groups
+// are frozen together without looping.
+auto SokobanGameState::FreezeCheck(int box_index, BoardBitboard& blocking) const noexcept -> std::pair<bool, bool> {
+    blocking.set(box_index);
+    bool off_goal = !level->is_goal(box_index);
+    const auto axis_blocked = [&](Action action) -> bool {
+        const int side_a = level->get_neighbour(box_index, action);
+        const int side_b = level->get_neighbour(box_index, opposite_action(action));
+        if (side_a == kNoCell || side_b == kNoCell || blocking.test(side_a) || blocking.test(side_b)) {
+            return true;
+        }
+        // Box could only be pushed onto a dead square along this axis
+        if (level->is_dead_square(side_a) && level->is_dead_square(side_b)) {
+            return true;
+        }
+        for (const int side : {side_a, side_b}) {
+            if (boxes.test(side)) {
+                const auto [side_frozen, side_off_goal] = FreezeCheck(side, blocking);
+                if (side_frozen) {
+                    off_goal = off_goal || side_off_goal;
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+    const bool frozen = axis_blocked(Action::kLeft) && axis_blocked(Action::kUp);
+    blocking.reset(box_index);
+    return {frozen, off_goal};
 }
 
 // ---------------------------------------------------------------------------
 
+void write_action_masks(std::span<const SokobanGameState> states, uint8_t* legal, uint8_t* push) noexcept {
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        const auto [legal_mask, push_mask] = states[i].ActionMasks();
+        legal[i] = legal_mask;
+        if (push != nullptr) {
+            push[i] = push_mask;
+        }
+    }
+}
+
 }    // namespace sokoban
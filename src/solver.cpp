@@ -0,0 +1,654 @@
+#include <sokoban/solver.h>
+
+#include <sokoban/push_generator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.h"
+
+namespace sokoban {
+
+namespace {
+// Replay a sequence of pushes from the initial state into a full action sequence
+auto pushes_to_actions(SokobanGameState state, const std::vector<PushMove>& pushes) -> std::vector<Action> {
+    PushGenerator generator;
+    std::vector<Action> actions;
+    for (const auto& push : pushes) {
+        generator.generate(state);
+        generator.append_push_actions(push, actions);
+        state.apply_push(push.agent_cell, push.direction);
+    }
+    return actions;
+}
+
+// Only the pushed box needs checking, the rest of the state was checked when the parent was generated
+auto is_push_deadlocked(const SolverOptions& options, const SokobanGameState& child, const PushMove& push) noexcept
+    -> bool {
+    return options.prune_deadlocks &&
+           child.is_box_deadlocked(child.get_level()->get_neighbour(push.box_cell, push.direction));
+}
+
+// Own tables of the best first searches start small so easy levels stay cheap, and double while at least half full
+constexpr std::size_t kInitialTableBytes = std::size_t{1} << 16;
+
+struct OpenEntry {
+    int f;
+    int g;
+    int node;
+};
+
+// Lowest f first, ties broken towards deeper nodes
+struct OpenCompare {
+    auto operator()(const OpenEntry& lhs, const OpenEntry& rhs) const noexcept -> bool {
+        return lhs.f > rhs.f || (lhs.f == rhs.f && lhs.g < rhs.g);
+    }
+};
+
+using OpenList = std::priority_queue<OpenEntry, std::vector<OpenEntry>, OpenCompare>;
+
+// Heuristic values of successors. The default matching heuristic is updated incrementally from the parent's matching,
+// custom heuristics are evaluated on each successor.
+class SuccessorHeuristic {
+public:
+    explicit SuccessorHeuristic(Heuristic heuristic) : heuristic(std::move(heuristic)) {}
+
+    auto evaluate(const SokobanGameState& state) -> int {
+        return heuristic ? heuristic(state) : matching.reset(state);
+    }
+
+    void set_parent(const SokobanGameState& state) {
+        if (!heuristic) {
+            matching.reset(state);
+        }
+    }
+
+    auto evaluate_child(const SokobanGameState& child, const PushMove& push) -> int {
+        if (heuristic) {
+            return heuristic(child);
+        }
+        return matching.evaluate_move(push.box_cell, child.get_level()->get_neighbour(push.box_cell, push.direction));
+    }
+
+private:
+    Heuristic heuristic;
+    MatchingHeuristic matching;
+};
+
+class AStarSearch {
+public:
+    AStarSearch(const SolverOptions& options, SolverResult& result)
+        : options(options), heuristic(options.heuristic), result(result), table(options.transposition_table) {}
+
+    void run(const SokobanGameState& initial_state) {
+        const int h = heuristic.evaluate(initial_state);
+        if (h == kInfiniteCost) {
+            return;
+        }
+        if (table == nullptr) {
+            owned_table = std::make_unique<TranspositionTable>(kInitialTableBytes);
+            table = owned_table.get();
+        } else {
+            // Entries of a previous search would turn this search's states into duplicates
+            table->clear();
+        }
+        nodes.push_back({initial_state, -1, 0, key_generator.canonical_key(initial_state), {}});
+        table->insert({.key = nodes.front().key, .g = 0});
+        open.push({h, 0, 0});
+        while (!open.empty()) {
+            const OpenEntry entry = open.top();
+            open.pop();
+            // Stale entry, state was reached again with a lower cost after this was queued
+            const auto& node = nodes[static_cast<std::size_t>(entry.node)];
+            const auto best = table->find(node.key);
+            if (best && entry.g > best->g) {
+                continue;
+            }
+            const SokobanGameState state = node.state;
+            const uint64_t state_key = node.key;
+            if (state.is_solution()) {
+                Solved(entry.node);
+                return;
+            }
+            if (options.max_expansions > 0 && result.stats.expanded >= options.max_expansions) {
+                result.status = SolverStatus::kLimitReached;
+                return;
+            }
+            ++result.stats.expanded;
+            generator.generate(state);
+            heuristic.set_parent(state);
+            for (const auto& push : generator.get_pushes()) {
+                SokobanGameState child = state;
+                child.apply_push(push.agent_cell, push.direction);
+                ++result.stats.generated;
+                if (is_push_deadlocked(options, child, push)) {
+                    ++result.stats.pruned;
+                    continue;
+                }
+                const int g = entry.g + 1;
+                const uint64_t key = key_generator.canonical_key(child);
+                if (table->insert({key, g, state_key, push}) == InsertResult::kDuplicate) {
+                    ++result.stats.duplicates;
+                    continue;
+                }
+                const int child_h = heuristic.evaluate_child(child, push);
+                if (child_h == kInfiniteCost) {
+                    ++result.stats.pruned;
+                    continue;
+                }
+                nodes.push_back({std::move(child), entry.node, g, key, push});
+                open.push({g + child_h, g, static_cast<int>(nodes.size() - 1)});
+            }
+            GrowTable();
+            const auto memory = MemoryBytes();
+            result.stats.peak_memory_bytes = std::max(result.stats.peak_memory_bytes, memory);
+            if (options.max_memory_bytes > 0 && memory > options.max_memory_bytes) {
+                result.status = SolverStatus::kLimitReached;
+                return;
+            }
+        }
+    }
+
+private:
+    struct Node {
+        SokobanGameState state;
+        int parent;
+        int g;
+        uint64_t key;
+        PushMove push;
+    };
+
+    [[nodiscard]] auto MemoryBytes() const noexcept -> std::size_t {
+        return (nodes.capacity() * sizeof(Node)) + table->get_memory_bytes() + (open.size() * sizeof(OpenEntry));
+    }
+
+    void GrowTable() {
+        const auto new_bytes = 2 * table->get_memory_bytes();
+        if (owned_table && 2 * table->get_size() > table->get_capacity() &&
+            (options.max_memory_bytes == 0 || MemoryBytes() + (new_bytes / 2) <= options.max_memory_bytes)) {
+            table->rehash(new_bytes);
+        }
+    }
+
+    void Solved(int node) {
+        std::vector<PushMove> pushes;
+        for (; nodes[static_cast<std::size_t>(node)].parent >= 0; node = nodes[static_cast<std::size_t>(node)].parent) {
+            pushes.push_back(nodes[static_cast<std::size_t>(node)].push);
+        }
+        std::reverse(pushes.begin(), pushes.end());
+        result.status = SolverStatus::kSolved;
+        result.num_pushes = static_cast<int>(pushes.size());
+        result.actions = pushes_to_actions(nodes.front().state, pushes);
+    }
+
+    const SolverOptions& options;
+    SuccessorHeuristic heuristic;
+    SolverResult& result;
+    PushGenerator generator;
+    PushGenerator key_generator;
+    std::vector<Node> nodes;
+    OpenList open;
+    TranspositionTable* table;
+    std::unique_ptr<TranspositionTable> owned_table;
+};
+
+class IDAStarSearch {
+public:
+    IDAStarSearch(const SolverOptions& options, SolverResult& result)
+        : options(options), heuristic(options.heuristic), result(result) {}
+
+    void run(const SokobanGameState& initial_state) {
+        int threshold = heuristic.evaluate(initial_state);
+        path_keys.push_back(key_generator.canonical_key(initial_state));
+        SokobanGameState state = initial_state;
+        while (threshold != kInfiniteCost) {
+            ++result.stats.iterations;
+            next_threshold = kInfiniteCost;
+            current_threshold = threshold;
+            if (Search(state, 0)) {
+                result.status = SolverStatus::kSolved;
+                result.num_pushes = static_cast<int>(path.size());
+                result.actions = pushes_to_actions(initial_state, path);
+                return;
+            }
+            if (limit_reached) {
+                result.status = SolverStatus::kLimitReached;
+                return;
+            }
+            threshold = next_threshold;
+        }
+    }
+
+private:
+    struct Child {
+        int h;
+        int order;
+        uint64_t key;
+        PushMove push;
+    };
+
+    // Search scratch space for one depth
+    struct Frame {
+        PushGenerator generator;
+        std::vector<Child> children;
+    };
+
+    [[nodiscard]] auto MemoryBytes() const noexcept -> std::size_t {
+        return (path_keys.capacity() * sizeof(uint64_t)) + (path.capacity() * sizeof(PushMove));
+    }
+
+    // Depth first search below the cost threshold, the current push sequence is kept in path. Pushes are applied to
+    // and undone on the one state, so no state is copied.
+    auto Search(SokobanGameState& state, int g) -> bool {
+        if (state.is_solution()) {
+            return true;
+        }
+        if (options.max_expansions > 0 && result.stats.expanded >= options.max_expansions) {
+            limit_reached = true;
+            return false;
+        }
+        ++result.stats.expanded;
+        // One frame per depth, deque so frames of shallower calls stay valid while deeper calls add more
+        const auto depth = static_cast<std::size_t>(g);
+        if (depth >= frames.size()) {
+            frames.emplace_back();
+        }
+        auto& [generator, children] = frames[depth];
+        generator.generate(state);
+        heuristic.set_parent(state);
+        children.clear();
+        for (const auto& push : generator.get_pushes()) {
+            const auto undo = state.apply_push_undoable(push.agent_cell, push.direction);
+            ++result.stats.generated;
+            AddChild(state, push, g + 1, children);
+            state.undo_action(undo);
+        }
+        result.stats.peak_memory_bytes = std::max(result.stats.peak_memory_bytes, MemoryBytes());
+
+        // Most promising children first, so the last iteration finds the solution early
+        std::sort(children.begin(), children.end(), [](const Child& lhs, const Child& rhs) {
+            return lhs.h < rhs.h || (lhs.h == rhs.h && lhs.order < rhs.order);
+        });
+        for (const auto& [child_h, order, key, push] : children) {
+            const auto undo = state.apply_push_undoable(push.agent_cell, push.direction);
+            path.push_back(push);
+            path_keys.push_back(key);
+            if (Search(state, g + 1)) {
+                return true;
+            }
+            path_keys.pop_back();
+            path.pop_back();
+            state.undo_action(undo);
+            if (limit_reached) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Queue the child if it is below the threshold and not pruned
+    void AddChild(const SokobanGameState& child, const PushMove& push, int g, std::vector<Child>& children) {
+        if (is_push_deadlocked(options, child, push)) {
+            ++result.stats.pruned;
+            return;
+        }
+        const uint64_t key = key_generator.canonical_key(child);
+        if (std::find(path_keys.begin(), path_keys.end(), key) != path_keys.end()) {
+            ++result.stats.duplicates;
+            return;
+        }
+        const int child_h = heuristic.evaluate_child(child, push);
+        if (child_h == kInfiniteCost) {
+            ++result.stats.pruned;
+            return;
+        }
+        if (g + child_h > current_threshold) {
+            next_threshold = std::min(next_threshold, g + child_h);
+            return;
+        }
+        children.push_back({child_h, static_cast<int>(children.size()), key, push});
+    }
+
+    const SolverOptions& options;
+    SuccessorHeuristic heuristic;
+    SolverResult& result;
+    int current_threshold = 0;
+    int next_threshold = kInfiniteCost;
+    bool limit_reached = false;
+    std::vector<PushMove> path;
+    std::vector<uint64_t> path_keys;    // Keys of the states along path, searched linearly as paths are short
+    PushGenerator key_generator;
+    std::deque<Frame> frames;
+};
+
+// Hash distributed A*. Every state has an owner thread picked by its key, and only the owner keeps it in its open list
+// and checks it for duplicates. Threads expand their best nodes in rounds and send successors owned by other threads
+// in one batch per destination at the end of each round. A solution found by any thread becomes the incumbent, whose
+// cost bounds all threads, and the search ends once no thread has open nodes below it and no batch is in flight.
+class HDAStarSearch {
+public:
+    HDAStarSearch(const SolverOptions& options, SolverResult& result)
+        : options(options),
+          result(result),
+          num_workers(options.num_threads > 0 ? options.num_threads
+                                              : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))) {}
+
+    void run(const SokobanGameState& initial_state) {
+        workers.reserve(static_cast<std::size_t>(num_workers));
+        for (int i = 0; i < num_workers; ++i) {
+            workers.push_back(std::make_unique<Worker>(options, i, num_workers));
+        }
+        if (options.transposition_table != nullptr) {
+            // Entries of a previous search would turn this search's states into duplicates
+            options.transposition_table->clear();
+            shared_table_bytes = options.transposition_table->get_memory_bytes();
+        }
+        Worker& root_worker = *workers.front();
+        const int h = root_worker.heuristic.evaluate(initial_state);
+        if (h == kInfiniteCost) {
+            return;
+        }
+        const uint64_t key = root_worker.key_generator.canonical_key(initial_state);
+        Accept(*workers[Owner(key)], {initial_state, 0, h, key, 0, {}, {}});
+        active.store(num_workers);
+
+        // One chunk per worker, as the pool splits the range into one chunk per thread
+        ThreadPool pool(num_workers);
+        pool.parallel_for(static_cast<std::size_t>(num_workers), [this](std::size_t begin, std::size_t) {
+            try {
+                Run(*workers[begin]);
+            } catch (...) {
+                // Let the other workers return instead of waiting for this one
+                stop.store(true);
+                throw;
+            }
+        });
+
+        for (const auto& worker : workers) {
+            result.stats.expanded += worker->stats.expanded;
+            result.stats.generated += worker->stats.generated;
+            result.stats.duplicates += worker->stats.duplicates;
+            result.stats.pruned += worker->stats.pruned;
+            result.stats.messages += worker->stats.messages;
+            result.stats.peak_memory_bytes = std::max(result.stats.peak_memory_bytes, worker->stats.peak_memory_bytes);
+        }
+        if (limit_reached.load()) {
+            result.status = SolverStatus::kLimitReached;
+        } else if (solution.worker >= 0) {
+            Solved(initial_state);
+        }
+    }
+
+private:
+    // Node in the node list of a worker
+    struct NodeRef {
+        int worker = -1;
+        int node = -1;
+    };
+
+    struct Node {
+        SokobanGameState state;
+        NodeRef parent;
+        int g;
+        uint64_t key;
+        PushMove push;
+    };
+
+    // Successor on its way to its owner, the heuristic is evaluated by the sender which has the parent's matching
+    struct Message {
+        SokobanGameState state;
+        int g;
+        int h;
+        uint64_t key;
+        uint64_t parent_key;
+        NodeRef parent;
+        PushMove push;
+    };
+
+    struct Worker {
+        Worker(const SolverOptions& options, int index, int num_workers)
+            : index(index),
+              heuristic(options.heuristic),
+              table(options.transposition_table),
+              outboxes(static_cast<std::size_t>(num_workers)) {
+            if (table == nullptr) {
+                owned_table = std::make_unique<TranspositionTable>(kInitialTableBytes);
+                table = owned_table.get();
+            }
+        }
+
+        int index;
+        SuccessorHeuristic heuristic;
+        PushGenerator generator;
+        PushGenerator key_generator;
+        std::vector<Node> nodes;
+        OpenList open;
+        TranspositionTable* table;
+        std::unique_ptr<TranspositionTable> owned_table;
+        std::vector<std::vector<Message>> outboxes;
+        std::mutex inbox_mutex;
+        std::vector<std::vector<Message>> inbox;
+        SolverStats stats;
+        std::size_t memory_bytes = 0;
+    };
+
+    // Expansions per round, between which received batches are accepted and outboxes are flushed
+    static constexpr int kRoundExpansions = 16;
+
+    // High bits pick the owner, the low bits pick entries in the owner's table
+    [[nodiscard]] auto Owner(uint64_t key) const noexcept -> std::size_t {
+        return static_cast<std::size_t>((key >> 32) % static_cast<uint64_t>(num_workers));
+    }
+
+    // Termination uses the active counter, which counts workers with open nodes plus batches not yet received.
+    // Senders count a batch before it becomes visible, and idle receivers count themselves before uncounting what
+    // they received, so the counter can only reach zero once all work is done.
+    void Run(Worker& worker) {
+        bool idle = false;
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::vector<std::vector<Message>> batches;
+            {
+                const std::lock_guard<std::mutex> lock(worker.inbox_mutex);
+                batches.swap(worker.inbox);
+            }
+            if (!batches.empty()) {
+                if (idle) {
+                    active.fetch_add(1);
+                    idle = false;
+                }
+                for (auto& batch : batches) {
+                    for (auto& message : batch) {
+                        Accept(worker, std::move(message));
+                    }
+                }
+                active.fetch_sub(static_cast<int>(batches.size()));
+            }
+            if (idle) {
+                if (active.load() == 0) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            for (int i = 0; i < kRoundExpansions && !worker.open.empty(); ++i) {
+                ExpandNext(worker);
+            }
+            Flush(worker);
+            UpdateMemory(worker);
+            if (worker.open.empty()) {
+                idle = true;
+                active.fetch_sub(1);
+            }
+            // Give threads sharing a core the chance to expand their nodes, a thread running ahead on its own open
+            // list expands nodes beyond the optimal cost
+            if (num_workers > 1) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Duplicate check against the owner's table and queueing, only called by the owner
+    void Accept(Worker& worker, Message&& message) {
+        if (message.g + message.h >= incumbent.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (worker.table->insert({message.key, message.g, message.parent_key, message.push}) ==
+            InsertResult::kDuplicate) {
+            ++worker.stats.duplicates;
+            return;
+        }
+        worker.nodes.push_back({std::move(message.state), message.parent, message.g, message.key, message.push});
+        worker.open.push({message.g + message.h, message.g, static_cast<int>(worker.nodes.size() - 1)});
+    }
+
+    void ExpandNext(Worker& worker) {
+        const OpenEntry entry = worker.open.top();
+        worker.open.pop();
+        // Open nodes are ordered by cost, so none of the rest can improve on the incumbent either
+        if (entry.f >= incumbent.load(std::memory_order_relaxed)) {
+            worker.open = OpenList();
+            return;
+        }
+        const auto& node = worker.nodes[static_cast<std::size_t>(entry.node)];
+        const auto best = worker.table->find(node.key);
+        if (best && entry.g > best->g) {
+            return;
+        }
+        const NodeRef ref{worker.index, entry.node};
+        const SokobanGameState state = node.state;
+        const uint64_t state_key = node.key;
+        if (state.is_solution()) {
+            const std::lock_guard<std::mutex> lock(solution_mutex);
+            if (entry.g < incumbent.load()) {
+                incumbent.store(entry.g);
+                solution = ref;
+            }
+            return;
+        }
+        if (options.max_expansions > 0 && expanded.fetch_add(1) >= options.max_expansions) {
+            limit_reached.store(true);
+            stop.store(true);
+            return;
+        }
+        ++worker.stats.expanded;
+        worker.generator.generate(state);
+        worker.heuristic.set_parent(state);
+        for (const auto& push : worker.generator.get_pushes()) {
+            SokobanGameState child = state;
+            child.apply_push(push.agent_cell, push.direction);
+            ++worker.stats.generated;
+            if (is_push_deadlocked(options, child, push)) {
+                ++worker.stats.pruned;
+                continue;
+            }
+            const int child_h = worker.heuristic.evaluate_child(child, push);
+            if (child_h == kInfiniteCost) {
+                ++worker.stats.pruned;
+                continue;
+            }
+            const uint64_t key = worker.key_generator.canonical_key(child);
+            Message message{std::move(child), entry.g + 1, child_h, key, state_key, ref, push};
+            const std::size_t owner = Owner(key);
+            if (owner == static_cast<std::size_t>(worker.index)) {
+                Accept(worker, std::move(message));
+            } else {
+                worker.outboxes[owner].push_back(std::move(message));
+                ++worker.stats.messages;
+            }
+        }
+    }
+
+    void Flush(Worker& worker) {
+        for (std::size_t i = 0; i < worker.outboxes.size(); ++i) {
+            auto& outbox = worker.outboxes[i];
+            if (outbox.empty()) {
+                continue;
+            }
+            active.fetch_add(1);
+            const std::lock_guard<std::mutex> lock(workers[i]->inbox_mutex);
+            workers[i]->inbox.push_back(std::move(outbox));
+            outbox.clear();
+        }
+    }
+
+    [[nodiscard]] static auto MemoryBytes(const Worker& worker) noexcept -> std::size_t {
+        return (worker.nodes.capacity() * sizeof(Node)) + (worker.open.size() * sizeof(OpenEntry)) +
+               (worker.owned_table ? worker.owned_table->get_memory_bytes() : 0);
+    }
+
+    // Own tables belong to one worker each, so they can grow without synchronisation
+    void UpdateMemory(Worker& worker) {
+        const auto& table = worker.owned_table;
+        if (table && 2 * table->get_size() > table->get_capacity() &&
+            (options.max_memory_bytes == 0 ||
+             memory_bytes.load() + shared_table_bytes + table->get_memory_bytes() <= options.max_memory_bytes)) {
+            table->rehash(2 * table->get_memory_bytes());
+        }
+        // Unsigned wrap around turns the change into a subtraction when the worker's lists shrank
+        const std::size_t change = MemoryBytes(worker) - worker.memory_bytes;
+        const std::size_t total = memory_bytes.fetch_add(change) + change + shared_table_bytes;
+        worker.memory_bytes += change;
+        worker.stats.peak_memory_bytes = std::max(worker.stats.peak_memory_bytes, total);
+        if (options.max_memory_bytes > 0 && total > options.max_memory_bytes) {
+            limit_reached.store(true);
+            stop.store(true);
+        }
+    }
+
+    void Solved(const SokobanGameState& initial_state) {
+        std::vector<PushMove> pushes;
+        for (NodeRef ref = solution; ref.worker >= 0;) {
+            const auto& node = workers[static_cast<std::size_t>(ref.worker)]->nodes[static_cast<std::size_t>(ref.node)];
+            if (node.parent.worker >= 0) {
+                pushes.push_back(node.push);
+            }
+            ref = node.parent;
+        }
+        std::reverse(pushes.begin(), pushes.end());
+        result.status = SolverStatus::kSolved;
+        result.num_pushes = static_cast<int>(pushes.size());
+        result.actions = pushes_to_actions(initial_state, pushes);
+    }
+
+    const SolverOptions& options;
+    SolverResult& result;
+    const int num_workers;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> active{0};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> limit_reached{false};
+    std::atomic<uint64_t> expanded{0};
+    std::atomic<std::size_t> memory_bytes{0};    // Memory of all workers, excluding a shared table
+    std::size_t shared_table_bytes = 0;
+    std::atomic<int> incumbent{kInfiniteCost};
+    std::mutex solution_mutex;
+    NodeRef solution;
+};
+}    // namespace
+
+auto solve(const SokobanGameState& state, const SolverOptions& options) -> SolverResult {
+    const auto start = std::chrono::steady_clock::now();
+    SolverResult result;
+    switch (options.algorithm) {
+        case SearchAlgorithm::kAStar:
+            AStarSearch(options, result).run(state);
+            break;
+        case SearchAlgorithm::kIDAStar:
+            IDAStarSearch(options, result).run(state);
+            break;
+        case SearchAlgorithm::kHDAStar:
+            HDAStarSearch(options, result).run(state);
+            break;
+    }
+    result.stats.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+}    // namespace sokoban
@@ -0,0 +1,138 @@
+#include "sprites.h"
+
+#include <sokoban/sokoban_base.h>
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace sokoban {
+
+namespace {
+// Binary image data, one set of sprites per tile size
+namespace assets_32 {
+#include "assets_all.inc"
+}    // namespace assets_32
+namespace assets_16 {
+#include "assets_16.inc"
+}    // namespace assets_16
+namespace assets_8 {
+#include "assets_8.inc"
+}    // namespace assets_8
+namespace assets_1 {
+#include "assets_1.inc"
+}    // namespace assets_1
+
+using AssetList = std::span<const std::pair<int, const unsigned char*>>;
+
+auto get_assets(TileSize tile_size) -> AssetList {
+    switch (tile_size) {
+        case TileSize::k1:
+            return assets_1::img_assets;
+        case TileSize::k8:
+            return assets_8::img_assets;
+        case TileSize::k16:
+            return assets_16::img_assets;
+        case TileSize::k32:
+            return assets_32::img_assets;
+    }
+    throw std::invalid_argument("Unknown tile size");
+}
+
+// ITU-R BT.601 luma weights, same as RGB to gray conversion in OpenCV
+constexpr uint32_t kLumaR = 299;
+constexpr uint32_t kLumaG = 587;
+constexpr uint32_t kLumaB = 114;
+constexpr uint32_t kLumaScale = 1000;
+}    // namespace
+
+SpriteAtlas::SpriteAtlas(TileSize tile_size, bool grayscale)
+    : tile_size(static_cast<std::size_t>(tile_size)),
+      row_len(this->tile_size * (grayscale ? 1 : SPRITE_CHANNELS)),
+      sprite_len(row_len * this->tile_size),
+      data(sprite_len * kNumSpriteFlags) {
+    const auto& assets = get_assets(tile_size);
+    const auto num_pixels = this->tile_size * this->tile_size;
+    const auto write_sprite = [&](int flags, const unsigned char* rgb) {
+        uint8_t* sprite = data.data() + (static_cast<std::size_t>(flags) * sprite_len);
+        if (!grayscale) {
+            std::memcpy(sprite, rgb, sprite_len);
+            return;
+        }
+        for (std::size_t i = 0; i < num_pixels; ++i) {
+            const uint32_t luma = (kLumaR * rgb[3 * i]) + (kLumaG * rgb[(3 * i) + 1]) + (kLumaB * rgb[(3 * i) + 2]);
+            sprite[i] = static_cast<uint8_t>((luma + (kLumaScale / 2)) / kLumaScale);
+        }
+    };
+    for (const auto& [flags, rgb] : assets) {
+        if (flags == 0) {
+            for (int f = 0; f < kNumSpriteFlags; ++f) {
+                write_sprite(f, rgb);
+            }
+        }
+    }
+    for (const auto& [flags, rgb] : assets) {
+        write_sprite(flags, rgb);
+    }
+}
+
+void SpriteAtlas::blit_sprite(int flags, uint8_t* img, int cols, int index) const noexcept {
+    const uint8_t* sprite = get_sprite(flags);
+    const std::size_t img_row_len = row_len * static_cast<std::size_t>(cols);
+    uint8_t* dst = img + TileOffset(cols, index);
+    for (std::size_t r = 0; r < tile_size; ++r) {
+        std::memcpy(dst, sprite, row_len);
+        dst += img_row_len;
+        sprite += row_len;
+    }
+}
+
+void SpriteAtlas::copy_tile(const uint8_t* src, uint8_t* dst, int cols, int index) const noexcept {
+    const std::size_t img_row_len = row_len * static_cast<std::size_t>(cols);
+    const auto offset = TileOffset(cols, index);
+    src += offset;
+    dst += offset;
+    for (std::size_t r = 0; r < tile_size; ++r) {
+        std::memcpy(dst, src, row_len);
+        dst += img_row_len;
+        src += img_row_len;
+    }
+}
+
+// Offset of the top left pixel of a tile
+auto SpriteAtlas::TileOffset(int cols, int index) const noexcept -> std::size_t {
+    const auto h = static_cast<std::size_t>(index / cols);
+    const auto w = static_cast<std::size_t>(index % cols);
+    return (h * sprite_len * static_cast<std::size_t>(cols)) + (w * row_len);
+}
+
+auto get_sprite_atlas(TileSize tile_size, bool grayscale) -> const SpriteAtlas& {
+    static const std::array<SpriteAtlas, 4> rgb_atlases = {
+        SpriteAtlas(TileSize::k1, false),
+        SpriteAtlas(TileSize::k8, false),
+        SpriteAtlas(TileSize::k16, false),
+        SpriteAtlas(TileSize::k32, false),
+    };
+    static const std::array<SpriteAtlas, 4> gray_atlases = {
+        SpriteAtlas(TileSize::k1, true),
+        SpriteAtlas(TileSize::k8, true),
+        SpriteAtlas(TileSize::k16, true),
+        SpriteAtlas(TileSize::k32, true),
+    };
+    const auto& atlases = grayscale ? gray_atlases : rgb_atlases;
+    switch (tile_size) {
+        case TileSize::k1:
+            return atlases[0];
+        case TileSize::k8:
+            return atlases[1];
+        case TileSize::k16:
+            return atlases[2];
+        case TileSize::k32:
+            return atlases[3];
+    }
+    throw std::invalid_argument("Unknown tile size");
+}
+
+}    // namespace sokoban
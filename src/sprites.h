@@ -0,0 +1,80 @@
+#ifndef SOKOBAN_SPRITES_H_
+#define SOKOBAN_SPRITES_H_
+
+#include <sokoban/definitions.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sokoban {
+
+// Sprites are looked up by cell flags, one bit (1 << Element) each for agent, wall, box and goal
+constexpr int kNumSpriteFlags = 16;
+
+/**
+ * Get the cell flags a tile is drawn with.
+ * @param agent True if the agent is on the cell
+ * @param wall True if the cell is a wall
+ * @param box True if a box is on the cell
+ * @param goal True if the cell is a goal
+ * @return Index into the sprite atlas
+ */
+constexpr auto get_sprite_flags(bool agent, bool wall, bool box, bool goal) noexcept -> int {
+    return (agent ? 1 << to_underlying(Element::kAgent) : 0) | (wall ? 1 << to_underlying(Element::kWall) : 0) |
+           (box ? 1 << to_underlying(Element::kBox) : 0) | (goal ? 1 << to_underlying(Element::kGoal) : 0);
+}
+
+// All sprites of one tile size and color mode in a single flat buffer, indexed by cell flags.
+// Combinations which can't appear on a board map to the empty sprite.
+class SpriteAtlas {
+public:
+    SpriteAtlas(TileSize tile_size, bool grayscale);
+
+    /**
+     * Get the HWC sprite for the given cell flags.
+     * @param flags Cell flags, see get_sprite_flags
+     * @return Pointer to get_sprite_len() bytes
+     */
+    [[nodiscard]] auto get_sprite(int flags) const noexcept -> const uint8_t* {
+        return data.data() + (static_cast<std::size_t>(flags) * sprite_len);
+    }
+
+    /**
+     * Copy a sprite into the tile of a HWC image, one sprite row at a time.
+     * @param flags Cell flags of the sprite to copy
+     * @param img Image of the full board, drawn with the same atlas
+     * @param cols Number of columns of the board
+     * @param index Flat index of the tile
+     */
+    void blit_sprite(int flags, uint8_t* img, int cols, int index) const noexcept;
+
+    /**
+     * Copy a tile between two HWC images of the same board size, one sprite row at a time.
+     * @param src Image to copy from
+     * @param dst Image to copy into
+     * @param cols Number of columns of the board
+     * @param index Flat index of the tile
+     */
+    void copy_tile(const uint8_t* src, uint8_t* dst, int cols, int index) const noexcept;
+
+private:
+    [[nodiscard]] auto TileOffset(int cols, int index) const noexcept -> std::size_t;
+
+    std::size_t tile_size;
+    std::size_t row_len;
+    std::size_t sprite_len;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * Get the shared atlas for a tile size and color mode.
+ * @param tile_size Pixels per side of each tile
+ * @param grayscale True for single channel luma sprites, RGB otherwise
+ * @return Atlas, built once on first use
+ */
+auto get_sprite_atlas(TileSize tile_size, bool grayscale) -> const SpriteAtlas&;
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_SPRITES_H_
@@ -0,0 +1,130 @@
+#include <sokoban/state_pool.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace sokoban {
+
+namespace {
+constexpr std::size_t kBitsPerWord = 64;
+
+// Reward signals are stored in a byte
+static_assert(kRewardBoxInGoal <= UINT8_MAX && kRewardAllBoxesInGoal <= UINT8_MAX && kRewardDeadlock <= UINT8_MAX,
+              "Reward codes must fit in a byte");
+static_assert(kMaxCells <= UINT16_MAX, "Agent cells must fit in 16 bits");
+}    // namespace
+
+StatePool::StatePool(const SokobanGameState& prototype, std::size_t max_memory_bytes, std::size_t states_per_slab)
+    : prototype(prototype),
+      box_words((static_cast<std::size_t>(prototype.get_level()->get_flat_size()) + kBitsPerWord - 1) / kBitsPerWord),
+      slab_shift(static_cast<std::size_t>(std::countr_zero(std::bit_ceil(std::max<std::size_t>(states_per_slab, 1))))),
+      slab_mask((std::size_t{1} << slab_shift) - 1),
+      max_slabs(0) {
+    const std::size_t slab_bytes = (slab_mask + 1) * get_record_bytes();
+    // Handles must address every state the budget allows
+    const std::size_t max_handle_slabs = (std::size_t{UINT32_MAX} + 1) >> slab_shift;
+    max_slabs = max_memory_bytes == 0 ? max_handle_slabs : std::min(max_memory_bytes / slab_bytes, max_handle_slabs);
+    if (max_slabs == 0) {
+        throw std::invalid_argument("Memory budget too small for a state pool slab");
+    }
+}
+
+auto StatePool::push(const SokobanGameState& state) -> std::optional<StateHandle> {
+    if (!SameLevel(state)) {
+        throw std::invalid_argument("State is of another level than the pool");
+    }
+    const std::size_t slab_index = num_states >> slab_shift;
+    const std::size_t offset = num_states & slab_mask;
+    if (slab_index == slabs.size()) {
+        if (slabs.size() == max_slabs) {
+            return std::nullopt;
+        }
+        const std::size_t slab_states = slab_mask + 1;
+        slabs.push_back({.agents = std::vector<uint16_t>(slab_states),
+                         .hashes = std::vector<uint64_t>(slab_states),
+                         .reward_signals = std::vector<uint8_t>(slab_states),
+                         .boxes = std::vector<uint64_t>(slab_states * box_words)});
+    }
+    auto& slab = slabs[slab_index];
+    slab.agents[offset] = static_cast<uint16_t>(state.agent_idx);
+    slab.hashes[offset] = state.zorb_hash;
+    slab.reward_signals[offset] = static_cast<uint8_t>(state.reward_signal);
+    std::copy_n(state.boxes.get_words().begin(), box_words, &slab.boxes[offset * box_words]);
+    return static_cast<StateHandle>(num_states++);
+}
+
+void StatePool::load(StateHandle handle, SokobanGameState& out) const {
+    if (handle >= num_states) {
+        throw std::out_of_range("State handle out of range");
+    }
+    if (!SameLevel(out)) {
+        throw std::invalid_argument("State is of another level than the pool");
+    }
+    const auto& slab = slabs[handle >> slab_shift];
+    const std::size_t offset = handle & slab_mask;
+    out.agent_idx = slab.agents[offset];
+    out.zorb_hash = slab.hashes[offset];
+    out.reward_signal = slab.reward_signals[offset];
+    auto& words = out.boxes.get_words();
+    std::copy_n(&slab.boxes[offset * box_words], box_words, words.begin());
+    std::fill(words.begin() + static_cast<std::ptrdiff_t>(box_words), words.end(), 0);
+}
+
+auto StatePool::get(StateHandle handle) const -> SokobanGameState {
+    SokobanGameState state = prototype;
+    load(handle, state);
+    return state;
+}
+
+auto StatePool::get_agent_index(StateHandle handle) const noexcept -> int {
+    return slabs[handle >> slab_shift].agents[handle & slab_mask];
+}
+
+auto StatePool::get_hash(StateHandle handle) const noexcept -> uint64_t {
+    return slabs[handle >> slab_shift].hashes[handle & slab_mask];
+}
+
+auto StatePool::is_solution(StateHandle handle) const noexcept -> bool {
+    const uint64_t* boxes = Boxes(handle);
+    const auto& goals = prototype.get_level()->get_goal_mask().get_words();
+    uint64_t missing = 0;
+    for (std::size_t i = 0; i < box_words; ++i) {
+        missing |= goals[i] & ~boxes[i];
+    }
+    return missing == 0;
+}
+
+void StatePool::clear() noexcept {
+    num_states = 0;
+}
+
+auto StatePool::size() const noexcept -> std::size_t {
+    return num_states;
+}
+
+auto StatePool::get_capacity() const noexcept -> std::size_t {
+    return slabs.size() << slab_shift;
+}
+
+auto StatePool::get_memory_bytes() const noexcept -> std::size_t {
+    return get_capacity() * get_record_bytes();
+}
+
+auto StatePool::get_record_bytes() const noexcept -> std::size_t {
+    return sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) + (box_words * sizeof(uint64_t));
+}
+
+auto StatePool::get_level() const noexcept -> const std::shared_ptr<const Level>& {
+    return prototype.get_level();
+}
+
+auto StatePool::SameLevel(const SokobanGameState& state) const noexcept -> bool {
+    return state.level == prototype.level || *state.level == *prototype.level;
+}
+
+auto StatePool::Boxes(StateHandle handle) const noexcept -> const uint64_t* {
+    return &slabs[handle >> slab_shift].boxes[(handle & slab_mask) * box_words];
+}
+
+}    // namespace sokoban
@@ -0,0 +1,95 @@
+#include "thread_pool.h"
+
+#include <stdexcept>
+
+namespace sokoban {
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads < 1) {
+        throw std::invalid_argument("num_threads < 1");
+    }
+    workers.reserve(static_cast<std::size_t>(num_threads - 1));
+    for (std::size_t i = 1; i < static_cast<std::size_t>(num_threads); ++i) {
+        workers.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+auto ThreadPool::num_threads() const noexcept -> int {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::parallel_for(std::size_t n, const RangeFunc& func) {
+    if (workers.empty() || n == 0) {
+        func(0, n);
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        job = &func;
+        job_size = n;
+        pending = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    start_cv.notify_all();
+
+    // Calling thread handles the first chunk
+    RunChunk(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [this]() { return pending == 0; });
+    job = nullptr;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::WorkerLoop(std::size_t worker_id) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&]() { return stop || generation != seen_generation; });
+            if (stop) {
+                return;
+            }
+            seen_generation = generation;
+        }
+        RunChunk(worker_id);
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+        }
+        done_cv.notify_one();
+    }
+}
+
+void ThreadPool::RunChunk(std::size_t chunk_id) noexcept {
+    const auto num_chunks = workers.size() + 1;
+    const auto begin = (job_size * chunk_id) / num_chunks;
+    const auto end = (job_size * (chunk_id + 1)) / num_chunks;
+    if (begin == end) {
+        return;
+    }
+    try {
+        (*job)(begin, end);
+    } catch (...) {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+}
+
+}    // namespace sokoban
@@ -0,0 +1,61 @@
+#ifndef SOKOBAN_THREAD_POOL_H_
+#define SOKOBAN_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sokoban {
+
+// Fixed set of worker threads which split index ranges between them.
+// The calling thread takes part in the work, so a pool of 1 thread runs everything inline.
+class ThreadPool {
+public:
+    using RangeFunc = std::function<void(std::size_t begin, std::size_t end)>;
+
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+    auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+    /**
+     * Get the number of threads work is split between, including the calling thread.
+     * @return Thread count
+     */
+    [[nodiscard]] auto num_threads() const noexcept -> int;
+
+    /**
+     * Split [0, n) into num_threads() contiguous chunks and run func on each, blocking until all are done.
+     * The chunking only depends on n and num_threads(). The first exception thrown by any chunk is rethrown.
+     * @param n Size of the range
+     * @param func Callable taking the begin and end of a chunk
+     */
+    void parallel_for(std::size_t n, const RangeFunc& func);
+
+private:
+    void WorkerLoop(std::size_t worker_id);
+    void RunChunk(std::size_t chunk_id) noexcept;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    const RangeFunc* job = nullptr;
+    std::size_t job_size = 0;
+    uint64_t generation = 0;
+    std::size_t pending = 0;
+    bool stop = false;
+    std::exception_ptr error;
+};
+
+}    // namespace sokoban
+
+#endif    // SOKOBAN_THREAD_POOL_H_
@@ -0,0 +1,173 @@
+#include <sokoban/transposition_table.h>
+
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+namespace sokoban {
+
+namespace {
+// Entries a key may be stored in, starting from its home position
+constexpr std::size_t kMaxProbes = 8;
+constexpr std::size_t kNoSlot = static_cast<std::size_t>(-1);
+
+constexpr int kCellBits = 16;
+constexpr int kDirectionShift = 2 * kCellBits;
+constexpr uint64_t kCellMask = (uint64_t{1} << kCellBits) - 1;
+// Cells offset by one must fit in kCellBits, this caps SOKOBAN_MAX_CELLS (see the README)
+static_assert(kMaxCells < UINT16_MAX, "Cells of pushes must fit in 16 bits");
+
+// Cells are stored offset by one so kNoCell packs to zero
+auto pack_push(const PushMove& push) noexcept -> uint64_t {
+    return static_cast<uint64_t>(push.agent_cell + 1) | (static_cast<uint64_t>(push.box_cell + 1) << kCellBits) |
+           (static_cast<uint64_t>(push.direction) << kDirectionShift);
+}
+
+auto unpack_push(uint64_t packed) noexcept -> PushMove {
+    return {.agent_cell = static_cast<int>(packed & kCellMask) - 1,
+            .box_cell = static_cast<int>((packed >> kCellBits) & kCellMask) - 1,
+            .direction = static_cast<Action>(packed >> kDirectionShift)};
+}
+}    // namespace
+
+TranspositionTable::TranspositionTable(std::size_t max_memory_bytes, ReplacementPolicy policy)
+    : policy(policy), slots(CapacityFor(max_memory_bytes)), mask(slots.size() - 1) {}
+
+auto TranspositionTable::insert(const TranspositionEntry& entry) noexcept -> InsertResult {
+    const auto home = static_cast<std::size_t>(entry.key) & mask;
+    std::size_t candidate = kNoSlot;
+    Snapshot candidate_snapshot{};
+    for (std::size_t i = 0; i < kMaxProbes; ++i) {
+        const std::size_t index = (home + i) & mask;
+        Slot& slot = slots[index];
+        while (true) {
+            const auto snapshot = Read(slot);
+            const bool empty = snapshot.entry.g < 0;
+            if (!empty && snapshot.entry.key != entry.key) {
+                if (policy == ReplacementPolicy::kReplaceHighestCost && snapshot.entry.g > entry.g &&
+                    (candidate == kNoSlot || snapshot.entry.g > candidate_snapshot.entry.g)) {
+                    candidate = index;
+                    candidate_snapshot = snapshot;
+                }
+                break;
+            }
+            if (!empty && snapshot.entry.g <= entry.g) {
+                return InsertResult::kDuplicate;
+            }
+            if (TryWrite(slot, snapshot.sequence, entry)) {
+                if (empty) {
+                    size.fetch_add(1, std::memory_order_relaxed);
+                    return InsertResult::kInserted;
+                }
+                return InsertResult::kImproved;
+            }
+            // Another thread wrote the entry since the snapshot, look at it again
+        }
+    }
+
+    if (policy == ReplacementPolicy::kAlwaysReplace) {
+        candidate = home;
+        candidate_snapshot = Read(slots[home]);
+    }
+    // Entries are only a cache at this point, give up if another thread changed the candidate in the meantime
+    if (candidate != kNoSlot && TryWrite(slots[candidate], candidate_snapshot.sequence, entry)) {
+        return InsertResult::kReplaced;
+    }
+    return InsertResult::kDropped;
+}
+
+auto TranspositionTable::find(uint64_t key) const noexcept -> std::optional<TranspositionEntry> {
+    const auto home = static_cast<std::size_t>(key) & mask;
+    for (std::size_t i = 0; i < kMaxProbes; ++i) {
+        const auto snapshot = Read(slots[(home + i) & mask]);
+        // Entries never become empty again, so the key can't be further along the window
+        if (snapshot.entry.g < 0) {
+            return std::nullopt;
+        }
+        if (snapshot.entry.key == key) {
+            return snapshot.entry;
+        }
+    }
+    return std::nullopt;
+}
+
+void TranspositionTable::clear() noexcept {
+    for (auto& slot : slots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.g.store(-1, std::memory_order_relaxed);
+    }
+    size.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::rehash(std::size_t max_memory_bytes) {
+    std::vector<Slot> old_slots(CapacityFor(max_memory_bytes));
+    old_slots.swap(slots);
+    mask = slots.size() - 1;
+    size.store(0, std::memory_order_relaxed);
+    for (const auto& slot : old_slots) {
+        const auto snapshot = Read(slot);
+        if (snapshot.entry.g >= 0) {
+            insert(snapshot.entry);
+        }
+    }
+}
+
+auto TranspositionTable::get_capacity() const noexcept -> std::size_t {
+    return slots.size();
+}
+
+auto TranspositionTable::get_size() const noexcept -> std::size_t {
+    return size.load(std::memory_order_relaxed);
+}
+
+auto TranspositionTable::get_memory_bytes() const noexcept -> std::size_t {
+    return slots.size() * sizeof(Slot);
+}
+
+auto TranspositionTable::get_policy() const noexcept -> ReplacementPolicy {
+    return policy;
+}
+
+// Sequence lock read, retried while a writer holds the entry (odd sequence) or changed it during the read
+auto TranspositionTable::Read(const Slot& slot) noexcept -> Snapshot {
+    while (true) {
+        const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1U) != 0) {
+            continue;
+        }
+        Snapshot snapshot{.sequence = sequence,
+                          .entry = {.key = slot.key.load(std::memory_order_relaxed),
+                                    .g = slot.g.load(std::memory_order_relaxed),
+                                    .parent_key = slot.parent_key.load(std::memory_order_relaxed),
+                                    .push = unpack_push(slot.push.load(std::memory_order_relaxed))}};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            return snapshot;
+        }
+    }
+}
+
+// Claim the entry if it is still at the snapshot's sequence, the release fence keeps the field stores after the claim
+auto TranspositionTable::TryWrite(Slot& slot, uint32_t sequence, const TranspositionEntry& entry) noexcept -> bool {
+    uint32_t expected = sequence;
+    if (!slot.sequence.compare_exchange_strong(expected, sequence + 1, std::memory_order_relaxed)) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.key.store(entry.key, std::memory_order_relaxed);
+    slot.g.store(entry.g, std::memory_order_relaxed);
+    slot.parent_key.store(entry.parent_key, std::memory_order_relaxed);
+    slot.push.store(pack_push(entry.push), std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+auto TranspositionTable::CapacityFor(std::size_t max_memory_bytes) -> std::size_t {
+    const std::size_t capacity = std::bit_floor(max_memory_bytes / sizeof(Slot));
+    if (capacity < kMaxProbes) {
+        throw std::invalid_argument("Memory cap too small for a transposition table");
+    }
+    return capacity;
+}
+
+}    // namespace sokoban
@@ -0,0 +1,141 @@
+#include <sokoban/vec_env.h>
+
+#include <span>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace sokoban {
+
+namespace {
+// SplitMix64, small per environment RNG so results don't depend on which environment is stepped first
+constexpr uint64_t SPLIT64_S1 = 30;
+constexpr uint64_t SPLIT64_S2 = 27;
+constexpr uint64_t SPLIT64_S3 = 31;
+constexpr uint64_t SPLIT64_C1 = 0x9E3779B97f4A7C15;
+constexpr uint64_t SPLIT64_C2 = 0xBF58476D1CE4E5B9;
+constexpr uint64_t SPLIT64_C3 = 0x94D049BB133111EB;
+auto next_random(uint64_t& state) noexcept -> uint64_t {
+    state += SPLIT64_C1;
+    uint64_t result = state;
+    result = (result ^ (result >> SPLIT64_S1)) * SPLIT64_C2;
+    result = (result ^ (result >> SPLIT64_S2)) * SPLIT64_C3;
+    return result ^ (result >> SPLIT64_S3);
+}
+}    // namespace
+
+SokobanVecEnv::SokobanVecEnv(std::vector<SokobanGameState> level_pool, int num_envs, uint64_t seed, bool compact,
+                             int num_threads)
+    : level_pool(std::move(level_pool)), compact(compact), thread_pool(std::make_unique<ThreadPool>(num_threads)) {
+    if (this->level_pool.empty()) {
+        throw std::invalid_argument("Level pool is empty");
+    }
+    if (num_envs < 1) {
+        throw std::invalid_argument("num_envs < 1");
+    }
+    const auto& first_level = this->level_pool.front().get_level();
+    for (const auto& state : this->level_pool) {
+        if (state.get_level()->get_rows() != first_level->get_rows() ||
+            state.get_level()->get_cols() != first_level->get_cols()) {
+            throw std::invalid_argument("All levels in the pool must have the same rows and cols");
+        }
+    }
+
+    states.reserve(static_cast<std::size_t>(num_envs));
+    rng_states.reserve(static_cast<std::size_t>(num_envs));
+    for (int i = 0; i < num_envs; ++i) {
+        uint64_t rng_state = seed + static_cast<uint64_t>(i);
+        rng_states.push_back(next_random(rng_state));
+        states.push_back(this->level_pool.front());
+    }
+    reset(nullptr);
+}
+
+SokobanVecEnv::~SokobanVecEnv() = default;
+SokobanVecEnv::SokobanVecEnv(SokobanVecEnv&&) noexcept = default;
+auto SokobanVecEnv::operator=(SokobanVecEnv&&) noexcept -> SokobanVecEnv& = default;
+
+auto SokobanVecEnv::num_envs() const noexcept -> int {
+    return static_cast<int>(states.size());
+}
+
+auto SokobanVecEnv::num_threads() const noexcept -> int {
+    return thread_pool->num_threads();
+}
+
+auto SokobanVecEnv::observation_shape() const noexcept -> std::array<int, 3> {
+    return level_pool.front().observation_shape(compact);
+}
+
+auto SokobanVecEnv::observation_size() const noexcept -> std::size_t {
+    const auto shape = observation_shape();
+    return static_cast<std::size_t>(shape[0] * shape[1] * shape[2]);
+}
+
+void SokobanVecEnv::reset(float* observations) {
+    thread_pool->parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            ResetEnv(i);
+            if (observations != nullptr) {
+                WriteObservation(i, observations);
+            }
+        }
+    });
+}
+
+void SokobanVecEnv::step(const int32_t* actions, uint64_t* reward_signals, uint8_t* solved, float* observations) {
+    for (std::size_t i = 0; i < states.size(); ++i) {
+        const auto action = static_cast<Action>(actions[i]);
+        if (!SokobanGameState::is_valid_action(action)) {
+            throw std::invalid_argument("Invalid action.");
+        }
+    }
+    thread_pool->parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto& state = states[i];
+            state.apply_action(static_cast<Action>(actions[i]));
+            reward_signals[i] = state.get_reward_signal();
+            solved[i] = state.is_solution() ? 1 : 0;
+            if (solved[i] != 0) {
+                ResetEnv(i);
+            }
+            if (observations != nullptr) {
+                WriteObservation(i, observations);
+            }
+        }
+    });
+}
+
+void SokobanVecEnv::observe(float* observations) const {
+    thread_pool->parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            WriteObservation(i, observations);
+        }
+    });
+}
+
+void SokobanVecEnv::action_masks(uint8_t* legal, uint8_t* push) const {
+    thread_pool->parallel_for(states.size(), [&](std::size_t begin, std::size_t end) {
+        const std::span<const SokobanGameState> chunk(states.data() + begin, end - begin);
+        write_action_masks(chunk, legal + begin, push == nullptr ? nullptr : push + begin);
+    });
+}
+
+auto SokobanVecEnv::get_state(int index) const -> const SokobanGameState& {
+    return states.at(static_cast<std::size_t>(index));
+}
+
+auto SokobanVecEnv::get_states() const noexcept -> const std::vector<SokobanGameState>& {
+    return states;
+}
+
+void SokobanVecEnv::ResetEnv(std::size_t index) {
+    const auto pool_idx = next_random(rng_states[index]) % level_pool.size();
+    states[index] = level_pool[pool_idx];
+}
+
+void SokobanVecEnv::WriteObservation(std::size_t index, float* observations) const {
+    states[index].write_observation(observations + (index * observation_size()), compact);
+}
+
+}    // namespace sokoban
@@ -0,0 +1,106 @@
+#include <sokoban/sokoban.h>
+
+#include <iostream>
+#include <string>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// 3x4 room with the goal in the middle row, every floor cell except the middle row is dead.
+// Pushing the box up moves it into a dead square.
+const std::string board_str_room =
+    "5|6|01|01|01|01|01|01|01|04|04|04|04|01|01|04|03|02|04|01|01|04|04|00|04|01|01|01|01|01|01|01";
+
+// Pushing the lower box up puts it next to the other box against the top wall, a freeze deadlock on live squares
+const std::string board_str_wall_freeze =
+    "5|7|01|01|01|01|01|01|01|01|03|04|02|04|04|01|01|04|04|04|02|04|01|01|04|04|04|00|03|01|01|01|01|01|01|01|01";
+
+// 2x2 square of boxes in the open, which can't be moved apart
+const std::string board_str_square =
+    "7|7|01|01|01|01|01|01|01|01|00|04|04|04|04|01|01|04|02|02|04|04|01|01|04|02|02|04|04|01|01|03|03|03|03|04|01|"
+    "01|04|04|04|04|04|01|01|01|01|01|01|01|01";
+
+// Same boxes without the bottom right one, each box can still be pushed
+const std::string board_str_corner =
+    "7|7|01|01|01|01|01|01|01|01|00|04|04|04|04|01|01|04|02|02|04|04|01|01|04|02|04|04|04|01|01|04|03|03|03|04|01|"
+    "01|04|04|04|04|04|01|01|01|01|01|01|01|01";
+
+// Dead squares are the floor cells a box can't be pushed to a goal from
+auto test_dead_squares() -> bool {
+    const SokobanGameState state(board_str_room);
+    const auto& level = *state.get_level();
+    if (level.get_dead_mask().count() != 10 || level.is_dead_square(14) || level.is_dead_square(15) ||
+        !level.is_dead_square(7) || level.is_dead_square(0)) {
+        std::cerr << "Unexpected dead squares" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Deadlocks should be detected, and only signalled in the reward when enabled
+auto test_deadlock_signal() -> bool {
+    for (const auto& str : {board_str_room, board_str_wall_freeze}) {
+        for (const bool enabled : {false, true}) {
+            SokobanGameState state(str);
+            state.set_deadlock_signal(enabled);
+            if (state.is_deadlocked()) {
+                std::cerr << "Initial state should not be deadlocked" << std::endl;
+                return false;
+            }
+            state.apply_action(Action::kUp);
+            const bool signalled = (state.get_reward_signal() & kRewardDeadlock) != 0;
+            if (!state.is_deadlocked() || signalled != enabled) {
+                std::cerr << "Deadlock not detected or signalled, enabled = " << enabled << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A 2x2 square is frozen, removing one box frees the rest
+auto test_square_freeze() -> bool {
+    if (!SokobanGameState(board_str_square).is_deadlocked() || SokobanGameState(board_str_corner).is_deadlocked()) {
+        std::cerr << "Unexpected 2x2 freeze result" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Pruning deadlocks must not change the optimal solution, and no state along it can be deadlocked
+auto test_solver_pruning() -> bool {
+    for (const auto& str : {board_str, board_str_boxoban}) {
+        const SokobanGameState state(str);
+        SolverOptions options;
+        const auto pruned = solve(state, options);
+        options.prune_deadlocks = false;
+        const auto unpruned = solve(state, options);
+        if (pruned.status != SolverStatus::kSolved || pruned.num_pushes != unpruned.num_pushes ||
+            pruned.stats.expanded > unpruned.stats.expanded) {
+            std::cerr << "Deadlock pruning changed the solution" << std::endl;
+            return false;
+        }
+        SokobanGameState replay = state;
+        for (const auto action : pruned.actions) {
+            replay.apply_action(action);
+            if (replay.is_deadlocked()) {
+                std::cerr << "State on the solution path reported as deadlocked" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_dead_squares();
+    passed &= test_deadlock_signal();
+    passed &= test_square_freeze();
+    passed &= test_solver_pruning();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <sokoban/sokoban.h>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Hash values produced by the original per-move SplitMix implementation, which must stay stable
+constexpr uint64_t kInitialHash = 1028774922328709516ULL;
+constexpr uint64_t kInitialHashBoxoban = 6734306654739749262ULL;
+constexpr std::array<int, 9> kActions = {2, 3, 0, 0, 0, 1, 0, 3, 2};
+constexpr std::array<uint64_t, 9> kExpectedHashes = {
+    10215780011538800410ULL, 1274622751007365603ULL,  2536498651716881940ULL,
+    15306684572509030245ULL, 6848617557549696333ULL,  18115091321998001519ULL,
+    11908234459355212970ULL, 11908234459355212970ULL, 16222512104005026421ULL,
+};
+
+// Reference hash, computed from scratch with SplitMix64 over every element
+auto split_mix(int flat_size, Element el, int offset) -> uint64_t {
+    auto seed = static_cast<uint64_t>((flat_size * static_cast<int>(el)) + offset);
+    uint64_t result = seed + 0x9E3779B97f4A7C15;
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9;    // NOLINT(*-magic-numbers)
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EB;    // NOLINT(*-magic-numbers)
+    return result ^ (result >> 31);                             // NOLINT(*-magic-numbers)
+}
+
+auto reference_hash(const SokobanGameState& state) -> uint64_t {
+    const auto& level = state.get_level();
+    const int flat_size = level->get_flat_size();
+    uint64_t hash = 0;
+    for (int i = 0; i < flat_size; ++i) {
+        hash ^= split_mix(flat_size, level->get_element(i), i);
+    }
+    hash ^= split_mix(flat_size, Element::kAgent, state.get_agent_index());
+    for (const auto& i : state.get_box_indices()) {
+        hash ^= split_mix(flat_size, Element::kBox, i);
+    }
+    return hash;
+}
+
+auto test_expected_values() -> bool {
+    SokobanGameState state(board_str);
+    if (state.get_hash() != kInitialHash) {
+        std::cerr << "Initial hash mismatch: " << state.get_hash() << std::endl;
+        return false;
+    }
+    if (SokobanGameState(board_str_boxoban).get_hash() != kInitialHashBoxoban) {
+        std::cerr << "Initial hash mismatch for boxoban level" << std::endl;
+        return false;
+    }
+    for (std::size_t i = 0; i < kActions.size(); ++i) {
+        state.apply_action(static_cast<Action>(kActions[i]));
+        if (state.get_hash() != kExpectedHashes[i]) {
+            std::cerr << "Hash mismatch at step " << i << ": " << state.get_hash() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+auto test_random_walk(const std::string& board) -> bool {
+    constexpr int NUM_STEPS = 10000;
+    SokobanGameState state(board);
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        state.apply_action(random_action(rng));
+        if (state.get_hash() != reference_hash(state)) {
+            std::cerr << "Hash mismatch against reference at step " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Undoing a random walk step by step should pass through the same states, hashes and reward signals backwards
+auto test_undo(const std::string& board) -> bool {
+    constexpr int NUM_STEPS = 2000;
+    SokobanGameState state(board);
+    std::vector<SokobanGameState> history;
+    std::vector<UndoRecord> undos;
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        history.push_back(state);
+        undos.push_back(state.apply_action_undoable(random_action(rng)));
+    }
+    while (!undos.empty()) {
+        state.undo_action(undos.back());
+        const auto& expected = history.back();
+        if (state != expected || state.get_hash() != expected.get_hash() ||
+            state.get_reward_signal() != expected.get_reward_signal()) {
+            std::cerr << "Undo mismatch at step " << undos.size() << std::endl;
+            return false;
+        }
+        undos.pop_back();
+        history.pop_back();
+    }
+    return true;
+}
+
+// Masks should hold exactly the actions which change the state, and the pushes among them
+auto test_action_masks(const std::string& board) -> bool {
+    constexpr int NUM_STEPS = 2000;
+    SokobanGameState state(board);
+    std::vector<SokobanGameState> history;
+    std::vector<uint8_t> expected_legal;
+    std::vector<uint8_t> expected_push;
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        uint8_t legal = 0;
+        uint8_t push = 0;
+        for (int a = 0; a < kNumActions; ++a) {
+            SokobanGameState next = state;
+            next.apply_action(static_cast<Action>(a));
+            const auto bit = static_cast<uint8_t>(1U << static_cast<unsigned>(a));
+            legal |= next != state ? bit : 0;
+            push |= next.get_box_bitboard() != state.get_box_bitboard() ? bit : 0;
+        }
+        if (state.legal_action_mask() != legal || state.push_action_mask() != push) {
+            std::cerr << "Action mask mismatch at step " << i << std::endl;
+            return false;
+        }
+        history.push_back(state);
+        expected_legal.push_back(legal);
+        expected_push.push_back(push);
+        state.apply_action(random_action(rng));
+    }
+    std::vector<uint8_t> legal(history.size());
+    std::vector<uint8_t> push(history.size());
+    write_action_masks(history, legal.data(), push.data());
+    if (legal != expected_legal || push != expected_push) {
+        std::cerr << "Batched action masks mismatch" << std::endl;
+        return false;
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_expected_values();
+    passed &= test_random_walk(board_str);
+    passed &= test_random_walk(board_str_boxoban);
+    passed &= test_undo(board_str);
+    passed &= test_undo(board_str_boxoban);
+    passed &= test_action_masks(board_str);
+    passed &= test_action_masks(board_str_boxoban);
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include <sokoban/sokoban.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Reference matching by trying every assignment of boxes to goals
+auto brute_force_matching(const SokobanGameState& state) -> int {
+    const auto& level = *state.get_level();
+    const auto boxes = state.get_box_indices();
+    std::vector<int> goals(level.get_goal_indices().size());
+    std::iota(goals.begin(), goals.end(), 0);
+    int best = kInfiniteCost;
+    do {
+        int total = 0;
+        for (std::size_t i = 0; i < boxes.size() && total != kInfiniteCost; ++i) {
+            const int distance = level.get_push_distance(goals[i], boxes[i]);
+            total = distance == kUnreachable ? kInfiniteCost : total + distance;
+        }
+        best = std::min(best, total);
+    } while (std::next_permutation(goals.begin(), goals.end()));
+    return best;
+}
+
+// Incremental updates should match a full solve and the brute force matching along random pushes
+auto test_incremental_matching() -> bool {
+    constexpr int NUM_STEPS = 5000;
+    constexpr int STEPS_PER_LEVEL = 200;
+    const std::vector<SokobanGameState> initial_states = {SokobanGameState(board_str),
+                                                          SokobanGameState(board_str_boxoban)};
+    SokobanGameState state = initial_states[0];
+    MatchingHeuristic incremental;
+    incremental.reset(state);
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        if (i % STEPS_PER_LEVEL == 0) {
+            state = initial_states[static_cast<std::size_t>(i / STEPS_PER_LEVEL) % initial_states.size()];
+            incremental.reset(state);
+        }
+        const auto action = random_action(rng);
+        const int box_cell = state.get_level()->get_neighbour(state.get_agent_index(), action);
+        const auto boxes = state.get_box_bitboard();
+        state.apply_action(action);
+        // Only pushes change the matching
+        if (state.get_box_bitboard() == boxes) {
+            continue;
+        }
+        const int box_new_cell = state.get_level()->get_neighbour(box_cell, action);
+        const int expected = brute_force_matching(state);
+        const int evaluated = incremental.evaluate_move(box_cell, box_new_cell);
+        const int moved = incremental.move_box(box_cell, box_new_cell);
+        if (evaluated != expected || moved != expected || matching_heuristic(state) != expected ||
+            greedy_heuristic(state) > expected) {
+            std::cerr << "Matching mismatch at step " << i << ", expected " << expected << ", got " << moved
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Heuristics should never exceed the optimal number of pushes
+auto test_admissible() -> bool {
+    for (const auto& str : {board_str, board_str_boxoban}) {
+        const SokobanGameState state(str);
+        SolverOptions options;
+        options.heuristic = manhattan_heuristic;
+        const auto result = solve(state, options);
+        if (result.status != SolverStatus::kSolved || matching_heuristic(state) > result.num_pushes ||
+            greedy_heuristic(state) > matching_heuristic(state) || manhattan_heuristic(state) > result.num_pushes) {
+            std::cerr << "Heuristic exceeds the optimal number of pushes" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_incremental_matching();
+    passed &= test_admissible();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
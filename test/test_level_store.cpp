@@ -0,0 +1,82 @@
+#include <sokoban/sokoban.h>
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+const std::string problems_path = SOKOBAN_PROBLEMS_DIR "/unfiltered_test.txt";
+
+// Every level of the file should give the same state as parsing its line on its own
+auto test_from_file() -> bool {
+    const auto store = LevelStore::from_file(problems_path);
+    std::ifstream file(problems_path);
+    std::string line;
+    std::size_t index = 0;
+    for (; std::getline(file, line); ++index) {
+        const SokobanGameState expected(line);
+        const auto state = store.get_state(index);
+        if (index >= store.size() || state != expected || state.get_hash() != expected.get_hash()) {
+            std::cerr << "Stored level " << index << " differs from its board string" << std::endl;
+            return false;
+        }
+    }
+    if (index != store.size() || store.get_states().size() != index) {
+        std::cerr << "Expected " << index << " levels, got " << store.size() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Invalid levels should be rejected naming their line, and leave a store they are added to unchanged
+auto test_invalid() -> bool {
+    const std::vector<std::string> invalid = {
+        "3|5|01|01|01|01|01|01|00|02|03|01|01|01|01|01",            // Too few codes
+        "3|5|01|01|01|01|01|01|00|02|03|01|01|01|01|01|01|01",      // Too many codes
+        "3|5|01|01|01|01|01|01|00|0x|03|01|01|01|01|01|01",         // Not a number
+        "3|5|01|01|01|01|01|01|00|02|09|01|01|01|01|01|01",         // Unknown code
+        "3|5|01|01|01|01|01|01|04|02|03|01|01|01|01|01|01",         // No agent
+        "3|5|01|01|01|01|01|01|00|02|04|01|01|01|01|01|01",         // Box without goal
+        "0|5|",                                                     // Empty board
+    };
+    LevelStore store;
+    store.add(board_str_one_push);
+    for (const auto& str : invalid) {
+        try {
+            store.add(str);
+            std::cerr << "Expected level to be rejected: " << str << std::endl;
+            return false;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    if (store.size() != 1 || store.get_codes(0).size() != 15 ||
+        store.get_state(0) != SokobanGameState(board_str_one_push)) {
+        std::cerr << "Rejected levels changed the store" << std::endl;
+        return false;
+    }
+    try {
+        (void)LevelStore::from_string(board_str_one_push + "\r\n\n" + invalid[0] + "\n");
+        return false;
+    } catch (const std::invalid_argument& e) {
+        if (std::string(e.what()).find("line 3") == std::string::npos) {
+            std::cerr << "Expected error to name line 3: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_from_file();
+    passed &= test_invalid();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <sokoban/sokoban.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Level which is solved by pushing right, the agent can also step down
+const std::string board_str_push_or_step = "4|5|01|01|01|01|01|01|00|02|03|01|01|04|04|04|01|01|01|01|01|01";
+
+// Uniform priors and a neutral value, so only terminal states guide the search
+void uniform_evaluator(const float* /*observations*/, std::size_t count, float* priors, float* values) {
+    for (std::size_t i = 0; i < count * kNumActions; ++i) {
+        priors[i] = 1.0F;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = 0.0F;
+    }
+}
+
+// Visits of the root's children plus the root's own evaluation should account for every simulation
+auto consistent(const MCTSResult& result, const MCTSOptions& options) -> bool {
+    const int child_visits = std::accumulate(result.visit_counts.begin(), result.visit_counts.end(), 0);
+    return result.num_simulations == options.num_simulations && child_visits == options.num_simulations - 1 &&
+           result.num_evaluations <= result.num_simulations &&
+           result.num_nodes <= 1 + (static_cast<std::size_t>(result.num_evaluations) * kNumActions);
+}
+
+// A search with batches and threads should find the push which solves the level
+auto test_finds_solution() -> bool {
+    const SokobanGameState state(board_str_push_or_step);
+    bool ok = true;
+    for (const int num_threads : {1, 4}) {
+        MCTSOptions options;
+        options.num_simulations = 200;
+        options.batch_size = 16;
+        options.num_threads = num_threads;
+        MCTS mcts(options);
+        const auto result = mcts.search(state, uniform_evaluator);
+        ok &= consistent(result, options) && result.best_action == Action::kRight &&
+              result.q_values[static_cast<std::size_t>(Action::kRight)] == options.solved_value &&
+              result.visit_counts[static_cast<std::size_t>(Action::kUp)] == 0;
+    }
+    if (!ok) {
+        std::cerr << "Search didn't find the solving push" << std::endl;
+    }
+    return ok;
+}
+
+// Batches should hold at most batch_size observations starting with the root's, and searches reusing the arena
+// should give the same result
+auto test_observations() -> bool {
+    const SokobanGameState state(board_str_boxoban);
+    MCTSOptions options;
+    options.num_simulations = 400;
+    options.batch_size = 8;
+    MCTS mcts(options);
+    const auto obs_size = state.get_observation(options.compact).size();
+    std::vector<float> root_obs(obs_size);
+    state.write_observation(root_obs.data(), options.compact);
+    bool ok = true;
+    bool first_batch = true;
+    std::size_t max_count = 0;
+    const auto evaluator = [&](const float* observations, std::size_t count, float* priors, float* values) {
+        // The first batch can only hold the root, the rest of its selections wait on it
+        if (first_batch) {
+            ok &= count == 1 && std::equal(root_obs.begin(), root_obs.end(), observations);
+            first_batch = false;
+        }
+        max_count = std::max(max_count, count);
+        uniform_evaluator(observations, count, priors, values);
+    };
+    const auto first = mcts.search(state, evaluator);
+    const auto capacity = mcts.get_arena_capacity();
+    first_batch = true;
+    const auto second = mcts.search(state, evaluator);
+    ok &= consistent(first, options) && max_count <= static_cast<std::size_t>(options.batch_size) &&
+          first.visit_counts == second.visit_counts && first.q_values == second.q_values &&
+          mcts.get_arena_capacity() == capacity && first.num_batches > 1 && first.max_depth > 1;
+    if (!ok) {
+        std::cerr << "Unexpected evaluator batches" << std::endl;
+    }
+    return ok;
+}
+
+// Priors should steer visits, a search trusting a prior fully should follow it
+auto test_priors() -> bool {
+    const SokobanGameState state(board_str_boxoban);
+    MCTSOptions options;
+    options.num_simulations = 100;
+    options.num_threads = 2;
+    MCTS mcts(options);
+    const auto result = mcts.search(state, [](const float*, std::size_t count, float* priors, float* values) {
+        for (std::size_t i = 0; i < count; ++i) {
+            for (int a = 0; a < kNumActions; ++a) {
+                priors[(i * kNumActions) + static_cast<std::size_t>(a)] = a == 0 ? 1.0F : 0.0F;
+            }
+            values[i] = 0.0F;
+        }
+    });
+    if (!consistent(result, options) || result.best_action != Action::kUp) {
+        std::cerr << "Search ignored the priors" << std::endl;
+        return false;
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_finds_solution();
+    passed &= test_observations();
+    passed &= test_priors();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
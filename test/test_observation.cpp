@@ -0,0 +1,77 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Cached observation should match a full rebuild after every step, including when switching levels
+auto test_cache_matches_rebuild(bool compact) -> bool {
+    constexpr int NUM_STEPS = 20000;
+    constexpr int STEPS_PER_LEVEL = 500;
+    const std::vector<SokobanGameState> initial_states = {SokobanGameState(board_str),
+                                                          SokobanGameState(board_str_boxoban)};
+    ObservationCache cache(compact);
+    SokobanGameState state = initial_states[0];
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        if (i % STEPS_PER_LEVEL == 0) {
+            state = initial_states[static_cast<std::size_t>(i / STEPS_PER_LEVEL) % initial_states.size()];
+        }
+        state.apply_action(random_action(rng));
+        if (cache.update(state) != state.get_observation(compact)) {
+            std::cerr << "Cached observation mismatch at step " << i << ", compact = " << compact << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Byte formats should carry the same information as the float observation
+auto test_formats_match_float(bool compact) -> bool {
+    constexpr int NUM_STEPS = 2000;
+    SokobanGameState state(board_str_boxoban);
+    const auto flat_size = static_cast<std::size_t>(state.get_level()->get_flat_size());
+    const auto plane_bytes = (flat_size + 7) / 8;
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        state.apply_action(random_action(rng));
+        const auto obs_float = state.get_observation(compact);
+        const auto obs_uint8 = state.get_observation_bytes(ObservationFormat::kUint8, compact);
+        const auto obs_packed = state.get_observation_bytes(ObservationFormat::kBitPacked, compact);
+        const auto obs_codes = state.get_observation_bytes(ObservationFormat::kCellCode);
+        const auto obs_one_hot = state.get_observation(false);
+        bool ok = obs_uint8.size() == obs_float.size() && obs_codes.size() == flat_size;
+        for (std::size_t j = 0; ok && j < obs_float.size(); ++j) {
+            const auto channel = j / flat_size;
+            const auto cell = j % flat_size;
+            const auto packed_bit = (obs_packed[(channel * plane_bytes) + (cell / 8)] >> (cell % 8)) & 1;
+            ok = static_cast<float>(obs_uint8[j]) == obs_float[j] && static_cast<float>(packed_bit) == obs_float[j];
+        }
+        // Cell codes match the one-hot channel index
+        for (std::size_t cell = 0; ok && cell < flat_size; ++cell) {
+            ok = obs_one_hot[(obs_codes[cell] * flat_size) + cell] == 1;
+        }
+        if (!ok) {
+            std::cerr << "Byte observation mismatch at step " << i << ", compact = " << compact << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_cache_matches_rebuild(true);
+    passed &= test_cache_matches_rebuild(false);
+    passed &= test_formats_match_float(true);
+    passed &= test_formats_match_float(false);
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Reference reachable region, found by trying every step from every reached state and keeping non-pushing ones
+auto reference_reachable(const SokobanGameState& state) -> std::vector<SokobanGameState> {
+    std::vector<SokobanGameState> reached = {state};
+    for (std::size_t i = 0; i < reached.size(); ++i) {
+        for (int a = 0; a < kNumActions; ++a) {
+            SokobanGameState next = reached[i];
+            next.apply_action(static_cast<Action>(a));
+            bool seen = next.get_box_bitboard() != state.get_box_bitboard();
+            for (const auto& s : reached) {
+                seen = seen || s.get_agent_index() == next.get_agent_index();
+            }
+            if (!seen) {
+                reached.push_back(next);
+            }
+        }
+    }
+    return reached;
+}
+
+// Pushes should match every box moving step from the reachable region, walks should replay to the same state,
+// and the canonical key should be shared by the whole region
+auto test_matches_reference() -> bool {
+    constexpr int NUM_STEPS = 300;
+    SokobanGameState state(board_str_boxoban);
+    PushGenerator generator;
+    PushGenerator key_generator;
+    uint64_t rng = 0;
+    for (int t = 0; t < NUM_STEPS; ++t) {
+        state.apply_action(random_action(rng));
+        generator.generate(state);
+        const auto region = reference_reachable(state);
+
+        std::size_t num_pushes = 0;
+        for (const auto& s : region) {
+            if (!generator.get_reachable().test(s.get_agent_index()) ||
+                key_generator.canonical_key(s) != generator.get_canonical_key()) {
+                std::cerr << "Reachable region mismatch at step " << t << std::endl;
+                return false;
+            }
+            for (int a = 0; a < kNumActions; ++a) {
+                SokobanGameState next = s;
+                next.apply_action(static_cast<Action>(a));
+                num_pushes += next.get_box_bitboard() != s.get_box_bitboard() ? 1 : 0;
+            }
+        }
+        if (static_cast<int>(region.size()) != generator.get_reachable().count() ||
+            num_pushes != generator.get_pushes().size()) {
+            std::cerr << "Push count mismatch at step " << t << std::endl;
+            return false;
+        }
+
+        for (const auto& push : generator.get_pushes()) {
+            std::vector<Action> actions;
+            generator.append_push_actions(push, actions);
+            SokobanGameState walked = state;
+            for (const auto action : actions) {
+                walked.apply_action(action);
+            }
+            SokobanGameState pushed = state;
+            pushed.apply_push(push.agent_cell, push.direction);
+            if (walked != pushed || walked.get_box_bitboard().test(push.box_cell)) {
+                std::cerr << "Push walk mismatch at step " << t << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Walks should start from the agent as of generate(), even after the state and its level were destroyed, and
+// unreachable targets throw
+auto test_walk_after_change() -> bool {
+    const SokobanGameState generated(board_str_boxoban);
+    PushGenerator generator;
+    generator.generate(SokobanGameState(board_str_boxoban));
+    bool ok = true;
+    generator.get_reachable().for_each([&](int cell) {
+        std::vector<Action> actions;
+        generator.append_walk(cell, actions);
+        SokobanGameState walked = generated;
+        for (const auto action : actions) {
+            walked.apply_action(action);
+        }
+        ok &= walked.get_agent_index() == cell;
+    });
+    try {
+        std::vector<Action> actions;
+        generator.append_walk(0, actions);
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    if (!ok) {
+        std::cerr << "Unexpected walk after the state changed" << std::endl;
+    }
+    return ok;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_matches_reference();
+    passed &= test_walk_after_change();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Rendered frames should match a full to_image() after every step, including when switching levels
+auto test_renderer_matches_to_image(TileSize tile_size, bool grayscale) -> bool {
+    constexpr int NUM_STEPS = 5000;
+    constexpr int STEPS_PER_LEVEL = 250;
+    // Levels of different sizes
+    const std::vector<SokobanGameState> initial_states = {SokobanGameState(board_str),
+                                                          SokobanGameState(board_str_one_push)};
+    Renderer renderer(tile_size, grayscale);
+    SokobanGameState state = initial_states[0];
+    uint64_t rng = 0;
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        if (i % STEPS_PER_LEVEL == 0) {
+            state = initial_states[static_cast<std::size_t>(i / STEPS_PER_LEVEL) % initial_states.size()];
+        }
+        state.apply_action(random_action(rng));
+        if (renderer.render(state) != state.to_image(tile_size, grayscale)) {
+            std::cerr << "Rendered image mismatch at step " << i << ", tile size = " << static_cast<int>(tile_size)
+                      << ", grayscale = " << grayscale << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Downscaled tiles should be the area average of the full resolution tiles
+auto test_downscaled_matches_area_average(TileSize tile_size) -> bool {
+    const SokobanGameState state(board_str);
+    const auto full = state.to_image();
+    const auto small = state.to_image(tile_size);
+    const auto shape = state.image_shape(tile_size);
+    const int scale = SPRITE_WIDTH / static_cast<int>(tile_size);
+    const int full_width = shape[1] * scale;
+    for (int y = 0; y < shape[0]; ++y) {
+        for (int x = 0; x < shape[1]; ++x) {
+            for (int c = 0; c < SPRITE_CHANNELS; ++c) {
+                int sum = 0;
+                for (int dy = 0; dy < scale; ++dy) {
+                    for (int dx = 0; dx < scale; ++dx) {
+                        const int full_idx = (((y * scale) + dy) * full_width + (x * scale) + dx) * SPRITE_CHANNELS + c;
+                        sum += full[static_cast<std::size_t>(full_idx)];
+                    }
+                }
+                const int expected = sum / (scale * scale);
+                const int actual = small[static_cast<std::size_t>(((y * shape[1] + x) * SPRITE_CHANNELS) + c)];
+                if (actual < expected || actual > expected + 1) {
+                    std::cerr << "Downscaled pixel mismatch at (" << y << ", " << x << ", " << c
+                              << "), tile size = " << static_cast<int>(tile_size) << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = true;
+    for (const auto tile_size : {TileSize::k1, TileSize::k8, TileSize::k16, TileSize::k32}) {
+        passed &= test_renderer_matches_to_image(tile_size, false);
+        passed &= test_renderer_matches_to_image(tile_size, true);
+        passed &= test_downscaled_matches_area_average(tile_size);
+    }
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+auto same_state(const SokobanGameState& lhs, const SokobanGameState& rhs) -> bool {
+    return lhs == rhs && lhs.get_hash() == rhs.get_hash() && lhs.get_reward_signal() == rhs.get_reward_signal() &&
+           lhs.is_deadlock_signal_enabled() == rhs.is_deadlock_signal_enabled();
+}
+
+// States along a walk should come back unchanged, including hash and signals
+auto test_round_trip() -> bool {
+    constexpr int NUM_STEPS = 500;
+    SokobanGameState state(board_str);
+    state.set_deadlock_signal(true);
+    for (int i = 0; i < NUM_STEPS; ++i) {
+        state.apply_action(static_cast<Action>((i * 7 + i / 3) % kNumActions));
+        const auto bytes = serialize(state);
+        if (bytes.size() != serialized_size(state) || !same_state(deserialize(bytes), state)) {
+            std::cerr << "State changed by a round trip at step " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Truncated, corrupt, and other version data should be rejected
+auto test_invalid() -> bool {
+    const auto bytes = serialize(SokobanGameState(board_str));
+    std::vector<std::vector<uint8_t>> invalid(5, bytes);
+    invalid[0].pop_back();
+    invalid[1][0] = 'X';
+    invalid[2][4] = kSerializationVersion + 1;
+    invalid[3][12] ^= 1;    // Number of boxes
+    invalid[4][24] ^= 1;    // Hash
+    // Second box on the goal of the small level, with a matching box count
+    auto extra_box = serialize(SokobanGameState(board_str_one_push));
+    extra_box[12] = 2;
+    extra_box[37] |= 1;
+    invalid.push_back(extra_box);
+    for (const auto& data : invalid) {
+        try {
+            (void)deserialize(data);
+            std::cerr << "Expected invalid data to be rejected" << std::endl;
+            return false;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return true;
+}
+
+// Batches should give back their states, with states of the same level sharing it
+auto test_batch() -> bool {
+    constexpr int NUM_STATES = 100;
+    std::vector<SokobanGameState> states = {SokobanGameState(board_str)};
+    for (int i = 1; i < NUM_STATES; ++i) {
+        states.push_back(states.back());
+        states.back().apply_action(static_cast<Action>(i % kNumActions));
+    }
+    const auto other_levels = LevelStore::from_file(SOKOBAN_PROBLEMS_DIR "/unfiltered_test_100.txt").get_states();
+    states.insert(states.end(), other_levels.begin(), other_levels.end());
+
+    const std::size_t record_size = serialized_size(states.front());
+    std::vector<uint8_t> data(states.size() * record_size);
+    serialize_batch(states, data.data());
+    const auto restored = deserialize_batch(data, record_size);
+    bool ok = restored.size() == states.size();
+    for (std::size_t i = 0; ok && i < states.size(); ++i) {
+        ok = same_state(restored[i], states[i]) &&
+             (restored[i].get_level() == restored[0].get_level()) == (i < NUM_STATES);
+    }
+    if (!ok) {
+        std::cerr << "Batch states differ from the serialized states" << std::endl;
+        return false;
+    }
+    try {
+        const std::vector<SokobanGameState> mixed = {states.front(), SokobanGameState(board_str_one_push)};
+        serialize_batch(mixed, data.data());
+        std::cerr << "Expected states of different dimensions to be rejected" << std::endl;
+        return false;
+    } catch (const std::invalid_argument&) {
+    }
+    return true;
+}
+
+// Archives should give back the states they were written from
+auto test_archive() -> bool {
+    const auto states = LevelStore::from_file(SOKOBAN_PROBLEMS_DIR "/unfiltered_test_100.txt").get_states();
+    const auto path = (std::filesystem::temp_directory_path() / "sokoban_test_serialization.skba").string();
+    StateArchive::write(path, states);
+    bool ok = true;
+    {
+        const StateArchive archive(path);
+        ok = archive.size() == states.size();
+        for (std::size_t i = 0; ok && i < states.size(); ++i) {
+            ok = same_state(archive.get_state(i), states[i]);
+        }
+    }
+    std::filesystem::remove(path);
+    if (!ok) {
+        std::cerr << "Archive states differ from the written states" << std::endl;
+    }
+    return ok;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_round_trip();
+    passed &= test_invalid();
+    passed &= test_batch();
+    passed &= test_archive();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
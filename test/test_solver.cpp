@@ -0,0 +1,104 @@
+#include <sokoban/sokoban.h>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+constexpr int NUM_THREADS = 4;
+
+// Box against the right wall which can't be pushed anywhere
+const std::string board_str_unsolvable = "3|6|01|01|01|01|01|01|01|03|00|04|02|01|01|01|01|01|01|01";
+
+// Solutions should solve the level when replayed, and all algorithms should agree on the optimal number of pushes
+auto test_solutions() -> bool {
+    for (const auto& str : {board_str_one_push, board_str, board_str_boxoban}) {
+        const SokobanGameState state(str);
+        int num_pushes = -1;
+        for (const auto algorithm : {SearchAlgorithm::kAStar, SearchAlgorithm::kIDAStar, SearchAlgorithm::kHDAStar}) {
+            SolverOptions options;
+            options.algorithm = algorithm;
+            options.num_threads = NUM_THREADS;
+            const auto result = solve(state, options);
+            SokobanGameState replay = state;
+            for (const auto action : result.actions) {
+                replay.apply_action(action);
+            }
+            if (result.status != SolverStatus::kSolved || !replay.is_solution()) {
+                std::cerr << "Expected a solution, algorithm = " << static_cast<int>(algorithm) << std::endl;
+                return false;
+            }
+            if (num_pushes >= 0 && result.num_pushes != num_pushes) {
+                std::cerr << "Solutions differ in number of pushes" << std::endl;
+                return false;
+            }
+            num_pushes = result.num_pushes;
+        }
+    }
+    return true;
+}
+
+// Unsolvable levels should be reported as such, and limits should stop the search
+auto test_status() -> bool {
+    for (const auto algorithm : {SearchAlgorithm::kAStar, SearchAlgorithm::kIDAStar, SearchAlgorithm::kHDAStar}) {
+        SolverOptions options;
+        options.algorithm = algorithm;
+        options.num_threads = NUM_THREADS;
+        if (solve(SokobanGameState(board_str_unsolvable), options).status != SolverStatus::kUnsolvable) {
+            std::cerr << "Expected level to be unsolvable" << std::endl;
+            return false;
+        }
+        options.max_expansions = 10;
+        const auto result = solve(SokobanGameState(board_str), options);
+        if (result.status != SolverStatus::kLimitReached || result.stats.expanded > options.max_expansions) {
+            std::cerr << "Expected expansion limit to be reached" << std::endl;
+            return false;
+        }
+    }
+    for (const auto algorithm : {SearchAlgorithm::kAStar, SearchAlgorithm::kHDAStar}) {
+        SolverOptions options;
+        options.algorithm = algorithm;
+        options.max_memory_bytes = 1024;
+        if (solve(SokobanGameState(board_str), options).status != SolverStatus::kLimitReached) {
+            std::cerr << "Expected memory limit to be reached" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// A table reused across searches should give the same result every time, also after a search of another level
+auto test_reused_table() -> bool {
+    TranspositionTable table(std::size_t{1} << 20);
+    for (const auto& str : {board_str_boxoban, board_str, board_str_boxoban}) {
+        const SokobanGameState state(str);
+        const auto expected = solve(state).num_pushes;
+        for (const auto algorithm : {SearchAlgorithm::kAStar, SearchAlgorithm::kHDAStar, SearchAlgorithm::kAStar}) {
+            SolverOptions options;
+            options.algorithm = algorithm;
+            options.num_threads = NUM_THREADS;
+            options.transposition_table = &table;
+            if (solve(state, options).num_pushes != expected) {
+                std::cerr << "Reused table changed the solution, algorithm = " << static_cast<int>(algorithm)
+                          << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_solutions();
+    passed &= test_status();
+    passed &= test_reused_table();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// States along a random walk, spanning several slabs
+auto random_walk(const std::string& board, int num_steps) -> std::vector<SokobanGameState> {
+    SokobanGameState state(board);
+    std::vector<SokobanGameState> states;
+    uint64_t rng = 0;
+    for (int i = 0; i < num_steps; ++i) {
+        state.apply_action(random_action(rng));
+        states.push_back(state);
+    }
+    return states;
+}
+
+// Stored states should come back equal, with their hash and reward signal, also after clearing and refilling
+auto test_round_trip() -> bool {
+    constexpr int NUM_STEPS = 5000;
+    constexpr std::size_t STATES_PER_SLAB = 1000;
+    bool ok = true;
+    for (const auto& board : {board_str, board_str_boxoban}) {
+        const auto states = random_walk(board, NUM_STEPS);
+        StatePool pool(states.front(), 0, STATES_PER_SLAB);
+        for (int pass = 0; pass < 2; ++pass) {
+            pool.clear();
+            std::vector<StateHandle> handles;
+            for (const auto& state : states) {
+                const auto handle = pool.push(state);
+                ok &= handle.has_value();
+                handles.push_back(handle.value_or(0));
+            }
+            SokobanGameState loaded(board);
+            for (std::size_t i = 0; ok && i < states.size(); ++i) {
+                pool.load(handles[i], loaded);
+                const auto& expected = states[i];
+                ok = loaded == expected && loaded.get_hash() == expected.get_hash() &&
+                     loaded.get_reward_signal() == expected.get_reward_signal() &&
+                     pool.get_hash(handles[i]) == expected.get_hash() &&
+                     pool.get_agent_index(handles[i]) == expected.get_agent_index() &&
+                     pool.is_solution(handles[i]) == expected.is_solution() && pool.get(handles[i]) == expected;
+            }
+        }
+        // Slabs are kept by clear(), so the second pass allocated nothing new
+        ok &= pool.size() == states.size() && pool.get_capacity() == 5 * 1024 &&
+              pool.get_memory_bytes() == pool.get_capacity() * pool.get_record_bytes();
+    }
+    if (!ok) {
+        std::cerr << "Stored states differ" << std::endl;
+    }
+    return ok;
+}
+
+// Pushes past the budget should be refused, and states of other levels rejected
+auto test_limits() -> bool {
+    constexpr std::size_t STATES_PER_SLAB = 64;
+    const SokobanGameState state(board_str);
+    const auto record_bytes = StatePool(state).get_record_bytes();
+    StatePool pool(state, 2 * STATES_PER_SLAB * record_bytes, STATES_PER_SLAB);
+    bool ok = true;
+    for (std::size_t i = 0; i < 2 * STATES_PER_SLAB; ++i) {
+        ok &= pool.push(state).has_value();
+    }
+    ok &= !pool.push(state).has_value() && pool.size() == 2 * STATES_PER_SLAB;
+    // The same board parsed again is the same level
+    ok &= pool.push(SokobanGameState(board_str)) == std::nullopt;
+    SokobanGameState solved(board_str_one_push);
+    StatePool small_pool(solved, 0, 1);
+    solved.apply_action(Action::kRight);
+    const auto handle = small_pool.push(solved);
+    ok &= handle && small_pool.is_solution(*handle) && small_pool.get_record_bytes() == 19;
+    try {
+        (void)pool.push(solved);
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    try {
+        pool.load(static_cast<StateHandle>(pool.size()), solved);
+        ok = false;
+    } catch (const std::out_of_range&) {
+    }
+    try {
+        const StatePool tiny(state, 1);
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    if (!ok) {
+        std::cerr << "Unexpected pool limits" << std::endl;
+    }
+    return ok;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_round_trip();
+    passed &= test_limits();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+constexpr uint64_t kKeyMultiplier = 0x9E3779B97F4A7C15;
+
+// Keys are found with the lowest cost inserted, and the push survives packing
+auto test_insert_find() -> bool {
+    TranspositionTable table(1 << 16);
+    const PushMove push{.agent_cell = 12, .box_cell = 13, .direction = Action::kRight};
+    bool ok = table.insert({.key = 42, .g = 5, .parent_key = 7, .push = push}) == InsertResult::kInserted;
+    ok &= table.insert({.key = 42, .g = 6}) == InsertResult::kDuplicate;
+    ok &= table.insert({.key = 42, .g = 5}) == InsertResult::kDuplicate;
+    const auto found = table.find(42);
+    ok &= found && found->g == 5 && found->parent_key == 7 && found->push.agent_cell == 12 &&
+          found->push.box_cell == 13 && found->push.direction == Action::kRight;
+    ok &= table.insert({.key = 42, .g = 3}) == InsertResult::kImproved && table.find(42)->g == 3;
+    ok &= !table.find(43) && table.get_size() == 1;
+    table.clear();
+    ok &= !table.find(42) && table.get_size() == 0;
+    if (!ok) {
+        std::cerr << "Unexpected insert or find result" << std::endl;
+    }
+    return ok;
+}
+
+// With every entry of a small table used, the policy decides whether a new key gets in
+auto test_replacement() -> bool {
+    bool ok = true;
+    using enum ReplacementPolicy;
+    for (const auto policy : {kKeepExisting, kReplaceHighestCost, kAlwaysReplace}) {
+        TranspositionTable table(256, policy);
+        for (uint64_t key = 0; key < table.get_capacity(); ++key) {
+            ok &= table.insert({.key = key, .g = static_cast<int>(10 + key)}) == InsertResult::kInserted;
+        }
+        const auto cheap = table.insert({.key = 100, .g = 1});
+        const auto expensive = table.insert({.key = 101, .g = 1000});
+        switch (policy) {
+            case kKeepExisting:
+                ok &= cheap == InsertResult::kDropped && expensive == InsertResult::kDropped && !table.find(100);
+                break;
+            case kReplaceHighestCost:
+                ok &= cheap == InsertResult::kReplaced && expensive == InsertResult::kDropped && table.find(100) &&
+                      !table.find(table.get_capacity() - 1);
+                break;
+            case kAlwaysReplace:
+                ok &= cheap == InsertResult::kReplaced && expensive == InsertResult::kReplaced && table.find(101);
+                break;
+        }
+    }
+    if (!ok) {
+        std::cerr << "Unexpected replacement result" << std::endl;
+    }
+    return ok;
+}
+
+// Threads inserting the same keys with different costs should leave every key once with its lowest cost
+auto test_concurrent() -> bool {
+    constexpr int NUM_THREADS = 4;
+    constexpr int NUM_KEYS = 20000;
+    TranspositionTable table(std::size_t{1} << 22, ReplacementPolicy::kKeepExisting);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&table, t]() {
+            for (int i = 0; i < NUM_KEYS; ++i) {
+                const auto key = static_cast<uint64_t>(i) * kKeyMultiplier;
+                table.insert({.key = key, .g = ((i + t) % NUM_THREADS) + 1, .parent_key = key + 1});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    bool ok = table.get_size() == NUM_KEYS;
+    for (int i = 0; ok && i < NUM_KEYS; ++i) {
+        const auto key = static_cast<uint64_t>(i) * kKeyMultiplier;
+        const auto found = table.find(key);
+        ok = found && found->g == 1 && found->parent_key == key + 1;
+    }
+    if (!ok) {
+        std::cerr << "Concurrent inserts lost or duplicated keys" << std::endl;
+    }
+    return ok;
+}
+
+// Solutions should not change when the search uses a shared table
+auto test_shared_table() -> bool {
+    const SokobanGameState state(board_str_boxoban);
+    TranspositionTable table(std::size_t{1} << 20);
+    SolverOptions options;
+    const auto expected = solve(state, options);
+    options.transposition_table = &table;
+    const auto result = solve(state, options);
+    if (result.status != SolverStatus::kSolved || result.num_pushes != expected.num_pushes || table.get_size() == 0) {
+        std::cerr << "Shared table changed the solution" << std::endl;
+        return false;
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_insert_find();
+    passed &= test_replacement();
+    passed &= test_concurrent();
+    passed &= test_shared_table();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}
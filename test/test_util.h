@@ -0,0 +1,37 @@
+#ifndef SOKOBAN_TEST_UTIL_H_
+#define SOKOBAN_TEST_UTIL_H_
+
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <string>
+
+// Levels and helpers shared by the tests
+namespace sokoban::test_util {
+
+inline const std::string board_str =
+    "10|10|01|01|01|01|01|01|01|01|01|01|01|03|04|04|01|01|01|01|01|01|01|04|02|02|04|01|01|01|01|01|01|04|03|03|"
+    "04|01|01|01|01|01|01|04|02|03|01|01|01|01|01|01|01|04|04|04|01|01|01|01|01|01|01|04|01|01|01|01|01|01|01|01|"
+    "01|02|00|01|01|01|01|01|01|01|01|04|04|01|01|01|01|01|01|01|01|01|01|01|01|01|01|01|01|01";
+
+inline const std::string board_str_boxoban =
+    "10|10|01|01|01|01|01|01|01|01|01|01|01|01|01|04|04|04|04|03|04|01|01|01|04|03|04|04|04|02|03|01|01|01|04|04|04|"
+    "04|03|02|04|01|01|01|01|01|01|04|04|04|04|01|01|01|01|01|04|04|04|01|01|01|01|01|01|01|01|04|02|01|01|01|01|01|"
+    "01|01|01|02|04|01|01|01|01|01|01|01|01|00|01|01|01|01|01|01|01|01|01|01|01|01|01|01";
+
+// Level which is solved by a single push right
+inline const std::string board_str_one_push = "3|5|01|01|01|01|01|01|00|02|03|01|01|01|01|01|01";
+
+// Reproducible pseudo random numbers from a 64 bit LCG, returning the better mixed high bits
+inline auto next_random(uint64_t& rng) noexcept -> uint64_t {
+    rng = (rng * 6364136223846793005ULL) + 1442695040888963407ULL;    // NOLINT(*-magic-numbers)
+    return rng >> 33;                                                 // NOLINT(*-magic-numbers)
+}
+
+inline auto random_action(uint64_t& rng) noexcept -> Action {
+    return static_cast<Action>(next_random(rng) % kNumActions);
+}
+
+}    // namespace sokoban::test_util
+
+#endif    // SOKOBAN_TEST_UTIL_H_
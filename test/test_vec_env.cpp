@@ -0,0 +1,130 @@
+#include <sokoban/sokoban.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+
+using namespace sokoban;
+using namespace sokoban::test_util;
+
+namespace {
+// Stepping the batch should match stepping each state on its own
+auto test_matches_single() -> bool {
+    constexpr int NUM_ENVS = 8;
+    constexpr int NUM_STEPS = 1000;
+    SokobanVecEnv env({SokobanGameState(board_str)}, NUM_ENVS);
+    std::vector<SokobanGameState> states(NUM_ENVS, SokobanGameState(board_str));
+    const auto obs_size = env.observation_size();
+    std::vector<int32_t> actions(NUM_ENVS);
+    std::vector<uint64_t> reward_signals(NUM_ENVS);
+    std::vector<uint8_t> solved(NUM_ENVS);
+    std::vector<float> obs(obs_size * NUM_ENVS);
+    uint64_t rng = 0;
+    for (int t = 0; t < NUM_STEPS; ++t) {
+        for (auto& a : actions) {
+            a = static_cast<int32_t>(random_action(rng));
+        }
+        env.step(actions.data(), reward_signals.data(), solved.data(), obs.data());
+        for (std::size_t i = 0; i < NUM_ENVS; ++i) {
+            states[i].apply_action(static_cast<Action>(actions[i]));
+            const auto expected_obs = states[i].get_observation(false);
+            const std::vector<float> env_obs(obs.begin() + static_cast<std::ptrdiff_t>(i * obs_size),
+                                             obs.begin() + static_cast<std::ptrdiff_t>((i + 1) * obs_size));
+            if (env.get_state(static_cast<int>(i)) != states[i] || expected_obs != env_obs ||
+                reward_signals[i] != states[i].get_reward_signal()) {
+                std::cerr << "Mismatch at step " << t << " env " << i << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Results should not depend on the number of threads
+auto test_thread_determinism() -> bool {
+    constexpr int NUM_ENVS = 64;
+    constexpr int NUM_STEPS = 500;
+    const std::vector<SokobanGameState> level_pool = {SokobanGameState(board_str), SokobanGameState(board_str_boxoban)};
+    const auto run = [&](int num_threads) {
+        SokobanVecEnv env(level_pool, NUM_ENVS, 1, true, num_threads);
+        std::vector<int32_t> actions(NUM_ENVS);
+        std::vector<uint64_t> reward_signals(NUM_ENVS);
+        std::vector<uint8_t> solved(NUM_ENVS);
+        std::vector<float> obs(env.observation_size() * NUM_ENVS);
+        std::vector<float> all_obs;
+        uint64_t rng = 0;
+        for (int t = 0; t < NUM_STEPS; ++t) {
+            for (auto& a : actions) {
+                a = static_cast<int32_t>(random_action(rng));
+            }
+            env.step(actions.data(), reward_signals.data(), solved.data(), obs.data());
+            all_obs.insert(all_obs.end(), obs.begin(), obs.end());
+        }
+        return all_obs;
+    };
+    if (run(1) != run(4)) {
+        std::cerr << "Results differ between thread counts" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Solved environments should report solved and be reset from the pool
+auto test_auto_reset() -> bool {
+    const SokobanGameState initial(board_str_one_push);
+    SokobanVecEnv env({initial}, 2);
+    const std::vector<int32_t> actions = {static_cast<int32_t>(Action::kRight), static_cast<int32_t>(Action::kLeft)};
+    std::vector<uint64_t> reward_signals(2);
+    std::vector<uint8_t> solved(2);
+    env.step(actions.data(), reward_signals.data(), solved.data(), nullptr);
+    if (solved[0] != 1 || solved[1] != 0 || reward_signals[0] != kRewardBoxInGoal) {
+        std::cerr << "Expected first environment to be solved" << std::endl;
+        return false;
+    }
+    if (env.get_state(0) != initial) {
+        std::cerr << "Expected solved environment to be reset" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Masks of the batch should match the masks of each state, whichever thread writes them
+auto test_action_masks() -> bool {
+    constexpr int NUM_ENVS = 64;
+    constexpr int NUM_STEPS = 100;
+    SokobanVecEnv env({SokobanGameState(board_str), SokobanGameState(board_str_boxoban)}, NUM_ENVS, 1, true, 4);
+    std::vector<int32_t> actions(NUM_ENVS);
+    std::vector<uint64_t> reward_signals(NUM_ENVS);
+    std::vector<uint8_t> solved(NUM_ENVS);
+    std::vector<uint8_t> legal(NUM_ENVS);
+    std::vector<uint8_t> push(NUM_ENVS);
+    uint64_t rng = 0;
+    for (int t = 0; t < NUM_STEPS; ++t) {
+        env.action_masks(legal.data(), push.data());
+        for (std::size_t i = 0; i < NUM_ENVS; ++i) {
+            const auto& state = env.get_states()[i];
+            if (legal[i] != state.legal_action_mask() || push[i] != state.push_action_mask()) {
+                std::cerr << "Batched action mask mismatch at step " << t << std::endl;
+                return false;
+            }
+        }
+        for (auto& a : actions) {
+            a = static_cast<int32_t>(random_action(rng));
+        }
+        env.step(actions.data(), reward_signals.data(), solved.data(), nullptr);
+    }
+    return true;
+}
+}    // namespace
+
+int main() {
+    bool passed = test_matches_single();
+    passed &= test_thread_determinism();
+    passed &= test_auto_reset();
+    passed &= test_action_masks();
+    std::cout << (passed ? "passed" : "failed") << std::endl;
+    return passed ? 0 : 1;
+}